@@ -11,17 +11,54 @@
 AbstractWaySimplifier::AbstractWaySimplifier(double epsilon) :
         m_epsilon(epsilon) { }
 
+void AbstractWaySimplifier::start_way(const osmium::WayNodeList& node_list) {
+    m_unit_vectors.clear();
+    for (const osmium::NodeRef& node_ref : node_list) {
+        m_unit_vectors.push_back(Vector3D::unit_vector(node_ref.location()));
+    }
+    m_kept.assign(node_list.size(), false);
+    m_kept.front() = true;
+    m_kept.back() = true;
+}
+
+void AbstractWaySimplifier::simplify_way(const bool ring) {
+    if (ring) {
+        simplify_ring_range();
+    } else {
+        simplify_range(0, m_kept.size() - 1);
+    }
+}
+
+void AbstractWaySimplifier::copy_kept_flags(const osmium::WayNodeList& node_list,
+        std::vector<const osmium::NodeRef*>& kept_node_refs) const {
+    for (size_t i = 0; i < m_kept.size(); ++i) {
+        if (m_kept[i]) {
+            kept_node_refs.at(i) = &node_list[i];
+        }
+    }
+}
+
 void AbstractWaySimplifier::simplify_closed_ring(const osmium::WayNodeList& node_list, std::vector<const osmium::NodeRef*>& kept_node_refs) {
     assert(kept_node_refs.size() == node_list.size());
+    start_way(node_list);
+    // The first and the last node are only kept if the caller has asked for it.
+    m_kept.front() = kept_node_refs.front() != nullptr;
+    m_kept.back() = kept_node_refs.back() != nullptr;
+    simplify_ring_range();
+    copy_kept_flags(node_list, kept_node_refs);
+}
+
+void AbstractWaySimplifier::simplify_ring_range() {
+    const size_t node_count = m_unit_vectors.size();
     // Keep the most distant and the second most distant node. The resulting area will not look nice if it
     // is only about as large as the maximum error or even smaller. But it will be valid!
     size_t vertex_max_distance = 1;
     size_t vertex_second_max_distance = 2;
     double largest_distance = 0;
     double second_largest_distance = 0;
-    for (size_t i = 1; i < node_list.size() - 1 ; ++i) {
-        double distance = m_distance_calculator.distance_from_line_sphere(node_list.front().location(),
-                node_list.back().location(), node_list[i].location());
+    const GreatCircle circle {m_unit_vectors.front(), m_unit_vectors.back()};
+    for (size_t i = 1; i < node_count - 1 ; ++i) {
+        double distance = circle.distance(m_unit_vectors[i]);
         if (distance > second_largest_distance) {
             if (distance > largest_distance) {
                 second_largest_distance = largest_distance;
@@ -38,8 +75,8 @@ void AbstractWaySimplifier::simplify_closed_ring(const osmium::WayNodeList& node
         std::swap(vertex_max_distance, vertex_second_max_distance);
     }
     // The node with the largest distance will be kept.
-    kept_node_refs.at(vertex_max_distance) = &node_list[vertex_max_distance];
-    kept_node_refs.at(vertex_second_max_distance) = &node_list[vertex_second_max_distance];
+    m_kept[vertex_max_distance] = true;
+    m_kept[vertex_second_max_distance] = true;
     if (largest_distance < m_epsilon) {
         // The largest distance from the start node to any other node is smaller than the threshold.
         // The area becomes a triangle (start point–most distant point–end point).
@@ -47,38 +84,52 @@ void AbstractWaySimplifier::simplify_closed_ring(const osmium::WayNodeList& node
     } else {
         // Add split point between the two subsegments to the vector of kept nodes.
         // All remaining work is done by the method for non-closed ways.
-        simplify_node_list(node_list, kept_node_refs, 0, vertex_max_distance);
-        simplify_node_list(node_list, kept_node_refs, vertex_max_distance, vertex_second_max_distance);
-        simplify_node_list(node_list, kept_node_refs, vertex_second_max_distance, node_list.size() - 1);
+        simplify_range(0, vertex_max_distance);
+        simplify_range(vertex_max_distance, vertex_second_max_distance);
+        simplify_range(vertex_second_max_distance, node_count - 1);
     }
 }
 
 void AbstractWaySimplifier::simplify_node_list(const osmium::WayNodeList& node_list, std::vector<const osmium::NodeRef*>& kept_node_refs,
         size_t segment_start_offset, size_t segment_end_offset) {
     assert(segment_end_offset < node_list.size());
-    if (segment_end_offset - segment_start_offset == 1) {
-        // Shortcut: If the segment is only two nodes long, it cannot be simplified any more.
-        return;
-    }
-    size_t vertex_max_distance = segment_end_offset;
-    double largest_distance = 0;
-    for (size_t i = segment_start_offset + 1; i < segment_end_offset ; ++i) {
-        double distance = m_distance_calculator.distance_from_line_sphere(node_list[segment_start_offset].location(),
-                node_list[segment_end_offset].location(), node_list[i].location());
-        if (distance > largest_distance && distance > m_epsilon) {
-            vertex_max_distance = i;
-            largest_distance = distance;
+    start_way(node_list);
+    m_kept.front() = kept_node_refs.front() != nullptr;
+    m_kept.back() = kept_node_refs.back() != nullptr;
+    simplify_range(segment_start_offset, segment_end_offset);
+    copy_kept_flags(node_list, kept_node_refs);
+}
+
+void AbstractWaySimplifier::simplify_range(size_t segment_start_offset, size_t segment_end_offset) {
+    assert(segment_end_offset < m_unit_vectors.size());
+    m_ranges.clear();
+    m_ranges.emplace_back(segment_start_offset, segment_end_offset);
+    while (!m_ranges.empty()) {
+        const size_t start = m_ranges.back().first;
+        const size_t end = m_ranges.back().second;
+        m_ranges.pop_back();
+        if (end - start <= 1) {
+            // Shortcut: If the segment is only two nodes long, it cannot be simplified any more.
+            continue;
+        }
+        size_t vertex_max_distance = end;
+        double largest_distance = 0;
+        const GreatCircle circle {m_unit_vectors[start], m_unit_vectors[end]};
+        for (size_t i = start + 1; i < end; ++i) {
+            double distance = circle.distance(m_unit_vectors[i]);
+            if (distance > largest_distance && distance > m_epsilon) {
+                vertex_max_distance = i;
+                largest_distance = distance;
+            }
+        }
+        if (vertex_max_distance == end) {
+            // Discard all inner nodes.
+            // There is no vertex whose distance from the line is larger than epsilon.
+            continue;
         }
-    }
-    if (vertex_max_distance == segment_end_offset) {
-        // Discard all inner nodes.
-        // There is no vertex whose distance from the line is larger than epsilon.
-        return;
-    } else {
         // Add split point between the two subsegments to the vector of kept nodes.
-        kept_node_refs.at(vertex_max_distance) = &node_list[vertex_max_distance];
-        simplify_node_list(node_list, kept_node_refs, segment_start_offset, vertex_max_distance);
-        simplify_node_list(node_list, kept_node_refs, vertex_max_distance, segment_end_offset);
+        m_kept[vertex_max_distance] = true;
+        m_ranges.emplace_back(vertex_max_distance, end);
+        m_ranges.emplace_back(start, vertex_max_distance);
     }
 }
-
@@ -22,6 +22,56 @@ protected:
 
     DistanceSpherePlain m_distance_calculator;
 
+    /**
+     * Unit vectors of the nodes of the way which is currently simplified.
+     *
+     * The vector is reused for all ways to avoid memory allocations.
+     */
+    std::vector<Vector3D> m_unit_vectors;
+
+    /**
+     * Flags of the nodes of the way which is currently simplified. A node is kept if its flag is set.
+     *
+     * The vector is reused for all ways to avoid memory allocations.
+     */
+    std::vector<bool> m_kept;
+
+    /// ranges of nodes (first and last offset) which still have to be simplified, reused for all ways
+    std::vector<std::pair<size_t, size_t>> m_ranges;
+
+    /**
+     * Prepare the simplification of a way.
+     *
+     * The locations of the nodes are converted to unit vectors and stored in #m_unit_vectors. The
+     * flags in #m_kept are reset, only the first and the last node are kept. Nodes which have to
+     * be preserved to prevent intersections have to be marked in #m_kept before simplify_way() is called.
+     */
+    void start_way(const osmium::WayNodeList& node_list);
+
+    /**
+     * Simplify the way prepared by start_way() and mark all nodes which are not omitted in #m_kept.
+     *
+     * \param ring treat the way as a closed ring
+     */
+    void simplify_way(const bool ring);
+
+    /**
+     * Douglas-Peucker algorithm for closed rings working on #m_unit_vectors and #m_kept.
+     */
+    void simplify_ring_range();
+
+    /**
+     * Douglas-Peucker algorithm for a part of a way working on #m_unit_vectors and #m_kept.
+     *
+     * The implementation is iterative to avoid stack overflows for very long ways.
+     */
+    void simplify_range(size_t segment_start_offset, size_t segment_end_offset);
+
+    /**
+     * Set the pointers to all nodes which are marked as kept.
+     */
+    void copy_kept_flags(const osmium::WayNodeList& node_list, std::vector<const osmium::NodeRef*>& kept_node_refs) const;
+
 public:
     AbstractWaySimplifier(double epsilon);
 
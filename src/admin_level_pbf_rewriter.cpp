@@ -0,0 +1,379 @@
+/*
+ * admin_level_pbf_rewriter.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <protozero/pbf_reader.hpp>
+#include <protozero/pbf_writer.hpp>
+#include <zlib.h>
+#include "admin_level_pbf_rewriter.hpp"
+#include "admin_rel_handlers.hpp"
+
+/// maximum number of unchanged data blobs which are copied at once
+constexpr size_t BLOBS_PER_BATCH = 256;
+
+/**
+ * Prepend the blob header and its size to a blob.
+ */
+static std::string make_blob(const std::string& type, const std::string& blob) {
+    std::string blob_header;
+    protozero::pbf_writer blob_header_writer {blob_header};
+    blob_header_writer.add_string(1, type);
+    blob_header_writer.add_int32(3, static_cast<int32_t>(blob.size()));
+    const uint32_t header_size = static_cast<uint32_t>(blob_header.size());
+    std::string result;
+    result.push_back(static_cast<char>((header_size >> 24) & 0xff));
+    result.push_back(static_cast<char>((header_size >> 16) & 0xff));
+    result.push_back(static_cast<char>((header_size >> 8) & 0xff));
+    result.push_back(static_cast<char>(header_size & 0xff));
+    return result + blob_header + blob;
+}
+
+/**
+ * Build a zlib compressed blob from a block.
+ */
+static std::string compress_block(const std::string& block) {
+    uLongf compressed_size = compressBound(static_cast<uLong>(block.size()));
+    std::string compressed (compressed_size, '\0');
+    if (compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressed_size,
+            reinterpret_cast<const Bytef*>(block.data()), static_cast<uLong>(block.size()),
+            Z_DEFAULT_COMPRESSION) != Z_OK) {
+        throw std::runtime_error{"Failed to compress PBF block"};
+    }
+    compressed.resize(compressed_size);
+    std::string blob;
+    protozero::pbf_writer blob_writer {blob};
+    blob_writer.add_int32(2, static_cast<int32_t>(block.size()));
+    blob_writer.add_bytes(3, compressed);
+    return blob;
+}
+
+static bool equals(const protozero::data_view& str, const char* other) {
+    const size_t length = std::strlen(other);
+    return str.size() == length && !std::memcmp(str.data(), other, length);
+}
+
+AdminLevelPbfRewriter::AdminLevelPbfRewriter(WayAdminLevelIndex& al_index,
+        const WayAdminLevelIndex::AdminLevel max_level, const std::string& input_filename,
+        const std::string& output_filename, const std::string& generator) :
+    m_al_index(al_index),
+    m_max_level(max_level),
+    m_locator(input_filename),
+    m_output_filename(output_filename) {
+    const std::string header_blob = build_header_blob(generator);
+    m_output.open(m_output_filename, std::ios::binary | std::ios::trunc);
+    if (!m_output) {
+        throw std::runtime_error{"Failed to open " + m_output_filename};
+    }
+    write(header_blob);
+}
+
+std::string AdminLevelPbfRewriter::build_header_blob(const std::string& generator) {
+    const std::string input_block = m_locator.header_block();
+    std::string block;
+    protozero::pbf_writer block_writer {block};
+    protozero::pbf_reader message {input_block.data(), input_block.size()};
+    while (message.next()) {
+        switch (message.tag()) {
+        case 1: { // bbox
+            const protozero::data_view bbox = message.get_view();
+            block_writer.add_message(1, bbox.data(), bbox.size());
+            break;
+        }
+        case 4: { // required_features
+            // Other features (e.g. history files) are left to the fallback which decodes all objects.
+            const std::string feature = message.get_string();
+            if (feature != "OsmSchema-V0.6" && feature != "DenseNodes") {
+                throw std::runtime_error{"Input file requires unsupported feature " + feature};
+            }
+            block_writer.add_string(4, feature);
+            break;
+        }
+        case 5: // optional_features
+            block_writer.add_string(5, message.get_string());
+            break;
+        case 17: // source
+            block_writer.add_string(17, message.get_string());
+            break;
+        case 32: // osmosis_replication_timestamp
+            block_writer.add_int64(32, message.get_int64());
+            break;
+        case 33: // osmosis_replication_sequence_number
+            block_writer.add_int64(33, message.get_int64());
+            break;
+        case 34: // osmosis_replication_base_url
+            block_writer.add_string(34, message.get_string());
+            break;
+        default: // writingprogram and unknown fields
+            message.skip();
+        }
+    }
+    block_writer.add_string(16, generator);
+
+    // The header blob is not compressed because it is tiny.
+    std::string blob;
+    protozero::pbf_writer blob_writer {blob};
+    blob_writer.add_bytes(1, block);
+    return make_blob("OSMHeader", blob);
+}
+
+const protozero::data_view& AdminLevelPbfRewriter::string_at(const uint32_t index) const {
+    if (index >= m_strings.size()) {
+        throw std::runtime_error{"Invalid string index in PBF block"};
+    }
+    return m_strings[index];
+}
+
+uint32_t AdminLevelPbfRewriter::string_index(const std::string& str) {
+    for (size_t i = 0; i < m_strings.size(); ++i) {
+        if (m_strings[i].size() == str.size() && !std::memcmp(m_strings[i].data(), str.data(), str.size())) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+    auto it = std::find(m_added_strings.cbegin(), m_added_strings.cend(), str);
+    if (it == m_added_strings.cend()) {
+        m_added_strings.push_back(str);
+        it = m_added_strings.cend() - 1;
+    }
+    return static_cast<uint32_t>(m_strings.size() + (it - m_added_strings.cbegin()));
+}
+
+bool AdminLevelPbfRewriter::find_edits(const std::string& block) {
+    m_strings.clear();
+    m_added_strings.clear();
+    m_edits.clear();
+    protozero::pbf_reader message {block.data(), block.size()};
+    while (message.next(1)) { // stringtable
+        protozero::pbf_reader string_table = message.get_message();
+        while (string_table.next(1)) {
+            m_strings.push_back(string_table.get_view());
+        }
+    }
+    size_t way_index = 0;
+    std::vector<uint32_t> keys;
+    std::vector<uint32_t> vals;
+    protozero::pbf_reader groups {block.data(), block.size()};
+    while (groups.next(2)) { // primitivegroup
+        protozero::pbf_reader group = groups.get_message();
+        while (group.next(3)) { // ways
+            protozero::pbf_reader way = group.get_message();
+            osmium::object_id_type id = 0;
+            keys.clear();
+            vals.clear();
+            while (way.next()) {
+                switch (way.tag()) {
+                case 1:
+                    id = way.get_int64();
+                    break;
+                case 2: {
+                    const auto range = way.get_packed_uint32();
+                    keys.assign(range.first, range.second);
+                    break;
+                }
+                case 3: {
+                    const auto range = way.get_packed_uint32();
+                    vals.assign(range.first, range.second);
+                    break;
+                }
+                default:
+                    way.skip();
+                }
+            }
+            const WayAdminLevelIndex::AdminLevel level = m_al_index.get(id, m_al_index_position);
+            WayAdminLevelIndex::AdminLevel level_old = WayAdminLevelIndex::NO_LEVEL;
+            for (size_t i = 0; i < keys.size() && i < vals.size(); ++i) {
+                if (equals(string_at(keys[i]), "admin_level")) {
+                    level_old = WayAdminLevelIndex::parse_admin_level(string_at(vals[i]).to_string().c_str());
+                    break;
+                }
+            }
+            if (AdminRelHandler2::needs_edit(level, level_old, m_max_level)) {
+                m_edits.push_back(WayEdit{way_index, level});
+            }
+            ++way_index;
+        }
+    }
+    return !m_edits.empty();
+}
+
+std::string AdminLevelPbfRewriter::edit_way(const protozero::data_view& way,
+        const WayAdminLevelIndex::AdminLevel level) {
+    std::vector<uint32_t> keys;
+    std::vector<uint32_t> vals;
+    std::string id;
+    protozero::pbf_writer id_writer {id};
+    std::string other_fields;
+    protozero::pbf_writer other_writer {other_fields};
+    protozero::pbf_reader message {way};
+    while (message.next()) {
+        switch (message.tag()) {
+        case 1:
+            id_writer.add_int64(1, message.get_int64());
+            break;
+        case 2: {
+            const auto range = message.get_packed_uint32();
+            keys.assign(range.first, range.second);
+            break;
+        }
+        case 3: {
+            const auto range = message.get_packed_uint32();
+            vals.assign(range.first, range.second);
+            break;
+        }
+        default: { // info and the node references, all of them are length-delimited
+            const protozero::pbf_tag_type tag = message.tag();
+            const protozero::data_view field = message.get_view();
+            other_writer.add_bytes(tag, field.data(), field.size());
+        }
+        }
+    }
+    // same tags as written by AdminRelHandler2::edit_way()
+    std::vector<uint32_t> new_keys;
+    std::vector<uint32_t> new_vals;
+    for (size_t i = 0; i < keys.size() && i < vals.size(); ++i) {
+        const protozero::data_view& key = string_at(keys[i]);
+        if (!equals(key, "admin_level") && !equals(key, "boundary")) {
+            new_keys.push_back(keys[i]);
+            new_vals.push_back(vals[i]);
+        }
+    }
+    if (level != WayAdminLevelIndex::NO_LEVEL) {
+        new_keys.push_back(string_index("admin_level"));
+        new_vals.push_back(string_index(std::to_string(static_cast<unsigned int>(level))));
+        new_keys.push_back(string_index("boundary"));
+        new_vals.push_back(string_index("administrative"));
+    }
+    std::string tags;
+    protozero::pbf_writer tags_writer {tags};
+    tags_writer.add_packed_uint32(2, new_keys.cbegin(), new_keys.cend());
+    tags_writer.add_packed_uint32(3, new_vals.cbegin(), new_vals.cend());
+    // Encoded fields can be concatenated.
+    return id + tags + other_fields;
+}
+
+std::string AdminLevelPbfRewriter::edit_block(const std::string& block) {
+    std::string groups;
+    protozero::pbf_writer groups_writer {groups};
+    std::string metadata;
+    protozero::pbf_writer metadata_writer {metadata};
+    std::vector<WayEdit>::const_iterator edit = m_edits.cbegin();
+    size_t way_index = 0;
+    protozero::pbf_reader message {block.data(), block.size()};
+    while (message.next()) {
+        switch (message.tag()) {
+        case 1: // stringtable, written below because strings might have been added
+            message.skip();
+            break;
+        case 2: { // primitivegroup
+            std::string group_data;
+            protozero::pbf_writer group_writer {group_data};
+            protozero::pbf_reader group = message.get_message();
+            while (group.next()) {
+                // All fields of a primitive group are messages.
+                const protozero::pbf_tag_type tag = group.tag();
+                const protozero::data_view object = group.get_view();
+                if (tag == 3 && edit != m_edits.cend() && edit->m_way == way_index) {
+                    group_writer.add_message(tag, edit_way(object, edit->m_level));
+                    ++edit;
+                } else {
+                    group_writer.add_message(tag, object.data(), object.size());
+                }
+                if (tag == 3) {
+                    ++way_index;
+                }
+            }
+            groups_writer.add_message(2, group_data);
+            break;
+        }
+        case 17: // granularity
+        case 18: // date_granularity
+            metadata_writer.add_int32(message.tag(), message.get_int32());
+            break;
+        case 19: // lat_offset
+        case 20: // lon_offset
+            metadata_writer.add_int64(message.tag(), message.get_int64());
+            break;
+        default:
+            throw std::runtime_error{"Unknown field in PBF block"};
+        }
+    }
+    std::string string_table;
+    protozero::pbf_writer string_table_writer {string_table};
+    for (const protozero::data_view& str : m_strings) {
+        string_table_writer.add_bytes(1, str.data(), str.size());
+    }
+    for (const std::string& str : m_added_strings) {
+        string_table_writer.add_bytes(1, str);
+    }
+    std::string result;
+    protozero::pbf_writer writer {result};
+    writer.add_message(1, string_table);
+    return result + groups + metadata;
+}
+
+void AdminLevelPbfRewriter::write(const std::string& data) {
+    m_output.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!m_output) {
+        throw std::runtime_error{"Failed to write to " + m_output_filename};
+    }
+}
+
+void AdminLevelPbfRewriter::copy(const size_t begin, const size_t end) {
+    write(m_locator.raw_blobs(begin, end));
+    m_copied_blob_count += end - begin;
+}
+
+void AdminLevelPbfRewriter::run(osmium::ProgressBar& progress_bar) {
+    const std::vector<PbfBlobLocator::Blob>& blobs = m_locator.data_blobs();
+    // Blobs before first and from last on do not contain ways in a sorted file.
+    size_t first = 0;
+    size_t last = blobs.size();
+    if (m_locator.sorted()) {
+        first = m_locator.first_blob_with(osmium::item_type::way);
+        last = std::min(m_locator.first_blob_with(osmium::item_type::relation) + 1, blobs.size());
+    }
+    for (size_t i = 0; i < first; i += BLOBS_PER_BATCH) {
+        copy(i, std::min(i + BLOBS_PER_BATCH, first));
+        progress_bar.update(blobs[i].m_offset);
+    }
+    // Unchanged blobs are collected and copied in batches.
+    size_t begin = first;
+    for (size_t i = first; i < last; ++i) {
+        const std::string block = m_locator.decompress(blobs[i]);
+        if (find_edits(block)) {
+            copy(begin, i);
+            write(make_blob("OSMData", compress_block(edit_block(block))));
+            ++m_rewritten_blob_count;
+            begin = i + 1;
+        } else if (i + 1 - begin == BLOBS_PER_BATCH) {
+            copy(begin, i + 1);
+            begin = i + 1;
+        }
+        progress_bar.update(blobs[i].m_offset);
+    }
+    copy(begin, last);
+    for (size_t i = last; i < blobs.size(); i += BLOBS_PER_BATCH) {
+        copy(i, std::min(i + BLOBS_PER_BATCH, blobs.size()));
+        progress_bar.update(blobs[i].m_offset);
+    }
+    m_output.close();
+    if (!m_output) {
+        throw std::runtime_error{"Failed to write to " + m_output_filename};
+    }
+}
+
+size_t AdminLevelPbfRewriter::file_size() const {
+    return static_cast<size_t>(m_locator.file_size());
+}
+
+size_t AdminLevelPbfRewriter::copied_blob_count() const {
+    return m_copied_blob_count;
+}
+
+size_t AdminLevelPbfRewriter::rewritten_blob_count() const {
+    return m_rewritten_blob_count;
+}
@@ -0,0 +1,130 @@
+/*
+ * admin_level_pbf_rewriter.hpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#ifndef SRC_ADMIN_LEVEL_PBF_REWRITER_HPP_
+#define SRC_ADMIN_LEVEL_PBF_REWRITER_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <protozero/data_view.hpp>
+#include <osmium/util/progress_bar.hpp>
+#include "pbf_blob_locator.hpp"
+#include "way_admin_level_index.hpp"
+
+/**
+ * \brief Transfer admin levels to ways of a PBF file and copy all other blocks byte by byte.
+ *
+ * Every block which might contain ways is decompressed once. If a way gets different
+ * admin_level or boundary tags (the same decision as in AdminRelHandler2), the block is re-encoded
+ * on the protobuf level: the changed ways get new key and value lists, missing strings are
+ * appended to the string table and all other objects are copied as they are. The re-encoded
+ * block is compressed with zlib and written to the output file directly. All other blocks are
+ * copied without being changed. In a file sorted by type and ID, the blocks before and after the
+ * way section are copied without decompressing them.
+ */
+class AdminLevelPbfRewriter {
+    /**
+     * \brief New tags of a way of the current block.
+     */
+    struct WayEdit {
+        /// position of the way in the block
+        size_t m_way;
+
+        WayAdminLevelIndex::AdminLevel m_level;
+    };
+
+    WayAdminLevelIndex& m_al_index;
+    WayAdminLevelIndex::AdminLevel m_max_level;
+    PbfBlobLocator m_locator;
+    std::string m_output_filename;
+    std::ofstream m_output;
+
+    /// position of the next lookup in m_al_index
+    size_t m_al_index_position = 0;
+
+    /// strings of the string table of the current block
+    std::vector<protozero::data_view> m_strings;
+
+    /// strings which are added to the string table of the current block
+    std::vector<std::string> m_added_strings;
+
+    /// ways of the current block whose tags have to be replaced, reused for all blocks
+    std::vector<WayEdit> m_edits;
+
+    size_t m_copied_blob_count = 0;
+    size_t m_rewritten_blob_count = 0;
+
+    /**
+     * Build the header blob of the output file from the header of the input file.
+     *
+     * \throws std::runtime_error if the input file requires features which are not supported
+     */
+    std::string build_header_blob(const std::string& generator);
+
+    /**
+     * Get a string of the string table of the current block.
+     *
+     * \throws std::runtime_error if the index is invalid
+     */
+    const protozero::data_view& string_at(const uint32_t index) const;
+
+    /**
+     * Get the index of a string in the string table of the current block. The string is added if
+     * it is missing.
+     */
+    uint32_t string_index(const std::string& str);
+
+    /**
+     * Find the ways of a block whose tags have to be replaced and fill m_strings and m_edits.
+     *
+     * \returns false if the block does not have to be changed
+     */
+    bool find_edits(const std::string& block);
+
+    /**
+     * Re-encode a way with new admin_level and boundary tags.
+     */
+    std::string edit_way(const protozero::data_view& way, const WayAdminLevelIndex::AdminLevel level);
+
+    /**
+     * Re-encode a block using the edits found by find_edits().
+     *
+     * \throws std::runtime_error if the block contains unknown fields
+     */
+    std::string edit_block(const std::string& block);
+
+    /**
+     * Copy a range of data blobs to the output file.
+     */
+    void copy(const size_t begin, const size_t end);
+
+    void write(const std::string& data);
+
+public:
+    /**
+     * \throws std::runtime_error if the input file cannot be handled block by block
+     */
+    AdminLevelPbfRewriter(WayAdminLevelIndex& al_index, const WayAdminLevelIndex::AdminLevel max_level,
+            const std::string& input_filename, const std::string& output_filename, const std::string& generator);
+
+    /**
+     * Write the output file.
+     *
+     * \throws std::runtime_error if a block of the input file cannot be handled. The output
+     * file is incomplete in that case.
+     */
+    void run(osmium::ProgressBar& progress_bar);
+
+    size_t file_size() const;
+
+    size_t copied_blob_count() const;
+
+    size_t rewritten_blob_count() const;
+};
+
+#endif /* SRC_ADMIN_LEVEL_PBF_REWRITER_HPP_ */
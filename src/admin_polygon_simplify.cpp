@@ -33,41 +33,63 @@
 #include <osmium/util/progress_bar.hpp>
 #include "way_simplify_handler2.hpp"
 #include "way_simplify_handler.hpp"
-#include "boundary_segment.hpp"
+#include "boundary_segment_store.hpp"
 #include "no_simplify_segment.hpp"
 #include "intermediate_simplifier.hpp"
 #include "boundary_relation_collector.hpp"
+#include "boundary_way_store.hpp"
+#include "kept_nodes_index.hpp"
+#include "relation_reader.hpp"
+#include "way_id_set.hpp"
 
 void print_help() {
     std::cerr << "Missing arguments, correct usage:\n" \
               << "admin_polygon_simplify [OPTIONS] INFILE OUTFILE\n" \
               << "Options:\n" \
+              << "-b, --boundaries-only\n" \
+              << "                     only simplify and write the member ways of boundary relations\n" \
+              << "                     and only write boundary relations\n" \
               << "-e E, --epsilon=E    set maximum error to E (default: 75 m)\n" \
               << "-i I, --iterations=I set maximum of iterations to I (default: 6)\n" \
               << "-h, --help           show help, i.e. this message\n" \
+              << "-m M, --memory=M     keep at most M MB of output in memory before using temporary files\n" \
+              << "                     (default: 1024)\n" \
+              << "-t N, --threads=N    use N threads to simplify, check and write ways (default: 1)\n" \
+              << "-T D, --tmp-dir=D    directory for temporary files (default: $TMPDIR or /tmp)\n" \
               << "-v, --verbose        verbose output\n";
 }
 
 int main(int argc, char* argv[]) {
     static struct option long_options[] = {
+        {"boundaries-only", no_argument, 0, 'b'},
         {"epsilon", required_argument, 0, 'e'},
         {"help", no_argument, 0, 'h'},
         {"iterations", required_argument, 0, 'i'},
+        {"memory", required_argument, 0, 'm'},
+        {"threads", required_argument, 0, 't'},
+        {"tmp-dir", required_argument, 0, 'T'},
         {"verbose", no_argument, 0, 'v'},
         {0, 0, 0, 0}
     };
     double max_error = 75;
     int iterations = 7;
+    int threads = 1;
+    long memory_budget_mb = 1024;
+    std::string tmp_directory = std::getenv("TMPDIR") ? std::getenv("TMPDIR") : "/tmp";
+    bool boundaries_only = false;
     bool verbose = false;
     std::string input_filename;
     std::string output_filename;
     while (true) {
-        int c = getopt_long(argc, argv, "e:hi:v", long_options, 0);
+        int c = getopt_long(argc, argv, "be:hi:m:t:T:v", long_options, 0);
         if (c == -1) {
             break;
         }
 
         switch (c) {
+        case 'b':
+            boundaries_only = true;
+            break;
         case 'e':
             max_error = std::atof(optarg);
             break;
@@ -77,6 +99,23 @@ int main(int argc, char* argv[]) {
         case 'i':
             iterations = std::atoi(optarg) + 1;
             break;
+        case 'm':
+            memory_budget_mb = std::atol(optarg);
+            if (memory_budget_mb < 1) {
+                std::cerr << "ERROR: The memory budget must be a positive number.\n";
+                exit(1);
+            }
+            break;
+        case 't':
+            threads = std::atoi(optarg);
+            if (threads < 1) {
+                std::cerr << "ERROR: The number of threads must be a positive number.\n";
+                exit(1);
+            }
+            break;
+        case 'T':
+            tmp_directory = optarg;
+            break;
         case 'v':
             verbose = true;
             break;
@@ -104,55 +143,82 @@ int main(int argc, char* argv[]) {
     osmium::io::File input_file(input_filename);
     osmium::util::VerboseOutput vout(verbose);
 
-    std::unordered_set<osmium::object_id_type> treat_as_rings_way;
+    WayIdSet treat_as_rings_way;
+    BoundaryWayStore way_store {input_file, boundaries_only};
     {
         vout << "Pass 1 – read boundary relations\n";
-        osmium::io::Reader reader{input_file, osmium::osm_entity_bits::relation};
-        BoundaryRelationCollector br_collector(treat_as_rings_way);
+        RelationReader reader{input_file};
+        BoundaryRelationCollector br_collector(treat_as_rings_way, way_store.member_ways());
         osmium::ProgressBar progress_bar{reader.file_size(), osmium::util::isatty(2)};
         while (osmium::memory::Buffer buffer = reader.read()) {
             progress_bar.update(reader.offset());
-            br_collector.read_relations(buffer.begin(), buffer.end());
+            osmium::apply(buffer, br_collector, way_store);
         }
+        reader.close();
+        progress_bar.done();
+        way_store.finish_relations();
 
         vout << "Pass 2 – read members of boundary relations\n";
-        osmium::io::Reader reader2{input_file, osmium::osm_entity_bits::way | osmium::osm_entity_bits::relation};
-        progress_bar.done();
+        // Relations are only members of relations we are not interested in. Therefore reading ways is sufficient.
+        osmium::io::Reader reader2{input_file, osmium::osm_entity_bits::way};
+        osmium::ProgressBar progress_bar2{reader2.file_size(), osmium::util::isatty(2)};
         while (osmium::memory::Buffer buffer = reader2.read()) {
-            progress_bar.update(reader2.offset());
-            osmium::apply(buffer, br_collector.handler());
+            progress_bar2.update(reader2.offset());
+            osmium::apply(buffer, br_collector, way_store);
         }
+        reader2.close();
+        progress_bar2.done();
+        br_collector.complete_relations();
+        treat_as_rings_way.sort();
+        vout << "Found " << treat_as_rings_way.size() << " ways forming rings of one or two ways (collector used "
+                << br_collector.used_memory() / (1024 * 1024) << " MB)\n";
+        vout << "Stored " << way_store.way_count() << " member ways of boundary relations in memory ("
+                << way_store.used_memory() / (1024 * 1024) << " MB), " << way_store.other_way_count()
+                << " ways which are not a member of any boundary relation "
+                << (boundaries_only ? "are skipped\n" : "will be read from the input file in every pass\n");
     }
 
     ErrorsMap errors;
     KeepNodesMap nodes_to_be_kept;
+    KeptNodesIndex kept_nodes_index;
     {
-        std::vector<BoundarySegment> segments;
-        vout << "Pass 3 – read ways\n";
-        osmium::io::Reader reader{input_file};
-        osmium::ProgressBar progress_bar{reader.file_size(), osmium::util::isatty(2)};
-        WaySimplifyHandler simplify_handler {max_error, segments, treat_as_rings_way};
-        while (osmium::memory::Buffer buffer = reader.read()) {
-            progress_bar.update(reader.offset());
-            osmium::apply(buffer, simplify_handler);
+        BoundarySegmentStore segments;
+        vout << "Pass 3 – simplify ways\n";
+        WaySimplifyHandler simplify_handler {max_error, segments, treat_as_rings_way, kept_nodes_index};
+        if (threads > 1) {
+            // Every way buffer is simplified by its own handler. The results are concatenated in the
+            // order of the buffers afterwards.
+            std::vector<BoundarySegmentStore> buffer_segments {way_store.way_buffers().size()};
+            std::vector<KeptNodesIndex> buffer_kept_nodes {way_store.way_buffers().size()};
+            way_store.for_each_way_buffer(threads,
+                    [max_error, &buffer_segments, &buffer_kept_nodes, &treat_as_rings_way]
+                    (const size_t index, osmium::memory::Buffer& buffer) {
+                WaySimplifyHandler simplify_handler {max_error, buffer_segments[index], treat_as_rings_way,
+                    buffer_kept_nodes[index]};
+                osmium::apply(buffer, simplify_handler);
+            });
+            for (size_t i = 0; i < buffer_segments.size(); ++i) {
+                segments.append(buffer_segments[i]);
+                buffer_segments[i] = BoundarySegmentStore();
+                kept_nodes_index.append(buffer_kept_nodes[i]);
+                buffer_kept_nodes[i] = KeptNodesIndex();
+            }
+        } else {
+            way_store.apply_ways(simplify_handler);
         }
-        reader.close();
-        progress_bar.done();
+        way_store.apply_other_ways(simplify_handler);
+        // The member ways are followed by the other ways.
+        kept_nodes_index.sort();
+        vout << "Created " << segments.size() << " segments (" << segments.used_memory() / (1024 * 1024) << " MB)\n";
 
-        IntermediateSimplifier interm_simplifier (max_error, errors, segments, nodes_to_be_kept, vout);
+        IntermediateSimplifier interm_simplifier (max_error, errors, segments, nodes_to_be_kept, vout, threads);
         vout << "Trying to eliminate intersections ...\n";
         int counter = 1;
         if (interm_simplifier.recheck_intersections()) {
             do {
                 vout << "Trying to avoid intersections of the simplified geometry, iteration " << counter << "\n";
-                osmium::io::Reader reader_i{input_file, osmium::osm_entity_bits::way};
-                osmium::ProgressBar progress_bar_i{reader_i.file_size(), osmium::util::isatty(2)};
-                while (osmium::memory::Buffer buffer = reader_i.read()) {
-                    progress_bar_i.update(reader.offset());
-                    osmium::apply(buffer, interm_simplifier);
-                }
-                reader_i.close();
-                progress_bar_i.done();
+                way_store.apply_ways(interm_simplifier);
+                way_store.apply_other_ways(interm_simplifier);
                 ++counter;
             } while (interm_simplifier.recheck_intersections() && counter < iterations);
         }
@@ -160,9 +226,6 @@ int main(int argc, char* argv[]) {
 
 
     vout << "Last pass\n";
-    osmium::io::Reader last_reader{input_file, osmium::osm_entity_bits::way | osmium::osm_entity_bits::relation};
-    osmium::ProgressBar progress_bar2{last_reader.file_size(), osmium::util::isatty(2)};
-
     osmium::io::Header header;
     header.set("generator", "admin_polygon_simplify");
     header.set("copyright", "OpenStreetMap and contributors");
@@ -171,11 +234,8 @@ int main(int argc, char* argv[]) {
 
     osmium::io::File output_file {output_filename};
     output_file.set("locations_on_ways", true);
-    WaySimplifyHandler2 simplify_handler2 {output_file, max_error, header, errors, nodes_to_be_kept, treat_as_rings_way};
-    while (osmium::memory::Buffer buffer = last_reader.read()) {
-        progress_bar2.update(last_reader.offset());
-        osmium::apply(buffer, simplify_handler2);
-    }
-    last_reader.close();
-    progress_bar2.done();
+    WaySimplifyHandler2 simplify_handler2 {output_file, max_error, header, errors, nodes_to_be_kept, kept_nodes_index,
+        treat_as_rings_way, tmp_directory, static_cast<size_t>(memory_budget_mb) * 1024 * 1024};
+    simplify_handler2.write_ways(way_store, threads);
+    way_store.apply_relations(simplify_handler2);
 }
@@ -92,6 +92,13 @@ void AdminRelHandler2::flush_ways() {
     m_buffer = init_buffer();
 }
 
+bool AdminRelHandler2::needs_edit(const WayAdminLevelIndex::AdminLevel level,
+        const WayAdminLevelIndex::AdminLevel level_old, const WayAdminLevelIndex::AdminLevel max_level) {
+    return !((level == WayAdminLevelIndex::NO_LEVEL && level_old == WayAdminLevelIndex::NO_LEVEL)
+            || level == level_old
+            || level_old > max_level);
+}
+
 AdminRelHandler2::AdminRelHandler2(WayAdminLevelIndex& al_index, osmium::io::File& outfile,
         const osmium::io::Header& header, WayAdminLevelIndex::AdminLevel max_level) :
     m_al_index(al_index),
@@ -100,6 +107,10 @@ AdminRelHandler2::AdminRelHandler2(WayAdminLevelIndex& al_index, osmium::io::Fil
     m_max_level(max_level) {}
 
 AdminRelHandler2::~AdminRelHandler2() {
+    // The input might not contain any relations.
+    if (m_buffer.committed() > 0) {
+        flush_ways();
+    }
     m_writer.flush();
     m_writer.close();
 }
@@ -109,12 +120,10 @@ void AdminRelHandler2::node(const osmium::Node& node) {
 }
 
 void AdminRelHandler2::way(const osmium::Way& way) {
-    WayAdminLevelIndex::AdminLevel level = m_al_index.get(way.id());
+    WayAdminLevelIndex::AdminLevel level = m_al_index.get(way.id(), m_al_index_position);
     const char* admin_level_old = way.get_value_by_key("admin_level");
     WayAdminLevelIndex::AdminLevel level_old = m_al_index.parse_admin_level(admin_level_old);
-    if ((level == WayAdminLevelIndex::NO_LEVEL && level_old == WayAdminLevelIndex::NO_LEVEL)
-            || level == level_old
-            || level_old > m_max_level) {
+    if (!needs_edit(level, level_old, m_max_level)) {
         // We flush the buffer every 100 MB only.
         if (m_buffer.committed() > 1024 * 1024 * 100) {
             flush_ways();
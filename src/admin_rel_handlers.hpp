@@ -33,6 +33,9 @@ class AdminRelHandler2 : public osmium::handler::Handler {
     WayAdminLevelIndex::AdminLevel m_max_level;
     bool m_seen_relation = false;
 
+    /// position of the next lookup in m_al_index
+    size_t m_al_index_position = 0;
+
     static osmium::memory::Buffer init_buffer();
 
     void write_object_unchanged(const osmium::OSMObject& obj);
@@ -42,6 +45,16 @@ class AdminRelHandler2 : public osmium::handler::Handler {
     void flush_ways();
 
 public:
+    /**
+     * Check if the admin_level and boundary tags of a way have to be replaced.
+     *
+     * \param level level of the way in the index
+     * \param level_old value of the admin_level tag of the way
+     * \param max_level maximum admin level of interest
+     */
+    static bool needs_edit(const WayAdminLevelIndex::AdminLevel level,
+            const WayAdminLevelIndex::AdminLevel level_old, const WayAdminLevelIndex::AdminLevel max_level);
+
     explicit AdminRelHandler2(WayAdminLevelIndex& al_index, osmium::io::File& outfile,
             const osmium::io::Header& header, WayAdminLevelIndex::AdminLevel max_level);
 
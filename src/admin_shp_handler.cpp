@@ -39,7 +39,7 @@ std::string AdminSHPHandler::get_layer_name(const std::string& path) {
 }
 
 void AdminSHPHandler::way(const osmium::Way& way) {
-    WayAdminLevelIndex::AdminLevel level = m_al_index.get(way.id());
+    WayAdminLevelIndex::AdminLevel level = m_al_index.get(way.id(), m_al_index_position);
     if (level == WayAdminLevelIndex::NO_LEVEL || level > m_max_level) {
     	return;
     }
@@ -16,6 +16,10 @@
 class AdminSHPHandler : public osmium::handler::Handler {
     WayAdminLevelIndex& m_al_index;
     WayAdminLevelIndex::AdminLevel m_max_level;
+
+    /// position of the next lookup in m_al_index
+    size_t m_al_index_position = 0;
+
     osmium::geom::OGRFactory<> m_factory {};
     gdalcpp::Dataset m_dataset;
     gdalcpp::Layer m_layer;
@@ -5,153 +5,88 @@
  *      Author: Michael Reichert
  */
 
-#include <assert.h>
-#include <iostream>
-#include <list>
+#include <algorithm>
+#include <cstring>
 #include <osmium/osm/item_type.hpp>
 #include "boundary_relation_collector.hpp"
 
-RingSegment::RingSegment(const osmium::Way* way) :
-        m_way(way),
-        m_reversed(false) {
-    assert(way);
-}
-
-bool RingSegment::reversed() {
-    return m_reversed;
-}
-
-void RingSegment::set_reversed() {
-    m_reversed = true;
-}
-
-osmium::object_id_type RingSegment::front_ref() {
-    if (m_reversed) {
-        return m_way->nodes().back().ref();
-    } else {
-        return m_way->nodes().front().ref();
-    }
-}
-
-osmium::object_id_type RingSegment::back_ref() {
-    if (m_reversed) {
-        return m_way->nodes().front().ref();
-    } else {
-        return m_way->nodes().back().ref();
-    }
-}
-
-Ring::Ring() :
-        m_ring_segments() {}
+BoundaryRelationCollector::BoundaryRelationCollector(WayIdSet& treat_as_rings_way,
+        const WayIdSet& member_ways) :
+        m_treat_as_rings_way(treat_as_rings_way),
+        m_first_members(1, 0),
+        m_member_ways(member_ways) { }
 
-Ring::Ring(RingSegment first_segment) :
-        m_ring_segments() {
-    m_ring_segments.push_back(first_segment);
-}
-
-osmium::object_id_type RingSegment::id() {
-    return m_way->id();
-}
-
-bool Ring::check_match(RingSegment& segment) {
-    if (m_ring_segments.front().front_ref() == segment.front_ref()
-            || m_ring_segments.front().front_ref() == segment.back_ref()
-            || m_ring_segments.back().back_ref() == segment.front_ref()
-            || m_ring_segments.back().back_ref() == segment.back_ref()) {
+bool BoundaryRelationCollector::keep_relation(const osmium::Relation& relation) {
+    const char* type = relation.get_value_by_key("type", "");
+    if (!strcmp(type, "boundary") || !strcmp(type, "multipolygon")) {
         return true;
     }
     return false;
 }
 
-void Ring::append(RingSegment&& segment) {
-    if (m_ring_segments.front().front_ref() == segment.front_ref()) {
-        segment.set_reversed();
-        m_ring_segments.push_front(segment);
-    } else if (m_ring_segments.front().front_ref() == segment.back_ref()) {
-        m_ring_segments.push_front(segment);
-    } else if (m_ring_segments.back().back_ref() == segment.front_ref()) {
-        m_ring_segments.push_back(segment);
-    } else if (m_ring_segments.back().back_ref() == segment.back_ref()) {
-        segment.set_reversed();
-        m_ring_segments.push_back(segment);
+void BoundaryRelationCollector::relation(const osmium::Relation& relation) {
+    if (!keep_relation(relation)) {
+        return;
     }
-}
-
-size_t Ring::size() {
-    return m_ring_segments.size();
-}
-
-bool Ring::closed() {
-    return m_ring_segments.front().front_ref() == m_ring_segments.back().back_ref();
-}
-
-osmium::object_id_type Ring::front_way_ref() {
-    return m_ring_segments.front().id();
-}
-
-osmium::object_id_type Ring::back_way_ref() {
-    return m_ring_segments.back().id();
-}
-
-
-BoundaryRelationCollector::BoundaryRelationCollector(std::unordered_set<osmium::object_id_type>& treat_as_rings_way) :
-        m_treat_as_rings_way(treat_as_rings_way) { }
-
-bool BoundaryRelationCollector::keep_relation(const osmium::Relation& relation) const {
-    const char* type = relation.get_value_by_key("type", "");
-    if (!strcmp(type, "boundary") || !strcmp(type, "multipolygon")) {
-        return true;
+    for (const osmium::RelationMember& member : relation.members()) {
+        if (member.type() == osmium::item_type::way) {
+            m_members.push_back(member.ref());
+        }
     }
-    return false;
+    m_first_members.push_back(m_members.size());
 }
 
-bool BoundaryRelationCollector::keep_member(const osmium::relations::RelationMeta&,
-        const osmium::RelationMember& member) const {
-    if (member.type() == osmium::item_type::way) {
-        return true;
+void BoundaryRelationCollector::way(const osmium::Way& way) {
+    if (way.nodes().empty() || !m_member_ways.contains(way.id(), m_member_ways_position)) {
+        return;
     }
-    return false;
+    m_way_ends.push_back(WayEnds{way.id(), way.nodes().front().ref(), way.nodes().back().ref()});
 }
 
-osmium::Way* BoundaryRelationCollector::get_member_way(size_t offset) const {
-    return static_cast<osmium::Way*>(&(this->get_member(offset)));
+const BoundaryRelationCollector::WayEnds* BoundaryRelationCollector::find_way_ends(
+        const osmium::object_id_type way_id) const {
+    auto it = std::lower_bound(m_way_ends.cbegin(), m_way_ends.cend(), way_id,
+            [](const WayEnds& ends, const osmium::object_id_type id) {
+        return ends.m_way_id < id;
+    });
+    if (it == m_way_ends.cend() || it->m_way_id != way_id) {
+        return nullptr;
+    }
+    return &(*it);
 }
 
-void BoundaryRelationCollector::complete_relation(osmium::relations::RelationMeta& relation_meta) {
-    const osmium::Relation& relation = this->get_relation(relation_meta);
-    std::vector<Ring> rings;
+void BoundaryRelationCollector::complete_relation(const size_t index) {
+    const size_t begin = m_first_members[index];
+    const size_t end = m_first_members[index + 1];
+    m_ring_assembler.clear(end - begin);
 
-    // iterate over members, build preliminary rings
-    for (const osmium::RelationMember& member : relation.members()) {
-        if (member.type() == osmium::item_type::way) {
-            std::pair<bool, size_t> avail_offset = get_availability_and_offset(member.type(), member.ref());
-            if (avail_offset.first) {
-                osmium::Way* way = this->get_member_way(this->get_offset(member.type(), member.ref()));
-                RingSegment ring_segment(way);
-                // check if any ring matches
-                bool ring_found = false;
-                for (Ring& r : rings) {
-                    if (r.check_match(ring_segment)) {
-                        r.append(std::move(ring_segment));
-                        ring_found = true;
-                        break;
-                    }
-                }
-                if (!ring_found) {
-                    Ring new_ring (ring_segment);
-                    rings.push_back(std::move(new_ring));
-                }
-            }
+    // assemble the member ways to rings using their first and last nodes
+    for (size_t i = begin; i < end; ++i) {
+        const WayEnds* ends = find_way_ends(m_members[i]);
+        if (!ends) {
+            // The relation is incomplete.
+            return;
         }
+        m_ring_assembler.add_way(ends->m_way_id, ends->m_front, ends->m_back);
     }
 
     // look for rings with only one or two member ways
-    for (Ring& r : rings) {
-        if (r.size() <= 2 && r.closed()) {
-            m_treat_as_rings_way.insert(r.front_way_ref());
-            if (r.size() == 2) {
-                m_treat_as_rings_way.insert(r.back_way_ref());
-            }
-        }
+    m_ring_assembler.for_each_way_of_small_rings([this](const osmium::object_id_type way_id) {
+        m_treat_as_rings_way.insert(way_id);
+    });
+}
+
+void BoundaryRelationCollector::complete_relations() {
+    // The ways are usually read in the order of their IDs. Sorting is cheap in this case.
+    std::sort(m_way_ends.begin(), m_way_ends.end(), [](const WayEnds& lhs, const WayEnds& rhs) {
+        return lhs.m_way_id < rhs.m_way_id;
+    });
+    for (size_t r = 0; r + 1 < m_first_members.size(); ++r) {
+        complete_relation(r);
     }
 }
+
+size_t BoundaryRelationCollector::used_memory() const {
+    return m_members.capacity() * sizeof(osmium::object_id_type) + m_first_members.capacity() * sizeof(size_t)
+            + m_way_ends.capacity() * sizeof(WayEnds);
+}
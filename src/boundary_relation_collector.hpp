@@ -8,147 +8,105 @@
 #ifndef SRC_BOUNDARY_RELATION_COLLECTOR_HPP_
 #define SRC_BOUNDARY_RELATION_COLLECTOR_HPP_
 
-#include <map>
-#include <unordered_set>
-#include <osmium/relations/collector.hpp>
-
-using intmap_t = std::map<int, int>;
+#include <vector>
+#include <osmium/handler.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/osm/way.hpp>
+#include "ring_assembler.hpp"
+#include "way_id_set.hpp"
 
 /**
- * \brief This class represents a segment of a ring, i.e. a way with additional information.
+ * \brief Relation collector for boundary relations.
+ *
+ * This collector collects boundary relations and tries to assemble rings in order to
+ * detect which rings have only one or two members.
+ *
+ * Assembling the rings only needs the first and the last node of every member way. Therefore
+ * only the member way IDs of the relations (first pass) and the IDs of the first and last node
+ * of the member ways (second pass) are kept instead of copies of the ways. Like with
+ * osmium::relations::Collector, relations with missing member ways are not processed.
  */
-class RingSegment {
-    /// geometry of this segment
-    const osmium::Way* m_way;
-
-    /// true if the way has to be reversed to get a continous ring
-    bool m_reversed;
-
-public:
-    RingSegment() = delete;
-
-    RingSegment(const osmium::Way* way);
-
-    /**
-     * \brief Is the segment's way reversed?
-     */
-    bool reversed();
-
+class BoundaryRelationCollector : public osmium::handler::Handler {
     /**
-     * \brief Set the reversed flag.
+     * \brief First and last node of a way.
      */
-    void set_reversed();
+    struct WayEnds {
+        osmium::object_id_type m_way_id;
+        osmium::object_id_type m_front;
+        osmium::object_id_type m_back;
+    };
 
     /**
-     * Get ID of first node.
+     * Set to track the IDs of the member ways of small rings (i.e. rings with only one or two members).
      *
-     * m_reverse is considered
+     * The set has to be sorted after all relations have been completed.
      */
-    osmium::object_id_type front_ref();
+    WayIdSet& m_treat_as_rings_way;
 
-    /**
-     * Get ID of last node.
-     *
-     * m_reverse is considered
-     */
-    osmium::object_id_type back_ref();
+    /// IDs of the member ways of all relations of interest, in the order of the members
+    std::vector<osmium::object_id_type> m_members;
 
-    /**
-     * Get ID of the underlying way
-     */
-    osmium::object_id_type id();
-};
+    /// position of the first member of each relation in m_members, plus the end of the last relation
+    std::vector<size_t> m_first_members;
 
-/**
- * \brief ring of a (multi)polygon.
- */
-class Ring {
-    std::list<RingSegment> m_ring_segments;
+    /// IDs of all member ways, collected by BoundaryWayStore
+    const WayIdSet& m_member_ways;
 
-public:
-    Ring();
+    /// position in m_member_ways where the next lookup starts
+    size_t m_member_ways_position = 0;
 
-    /**
-     * The first segment is handed over
-     *
-     * \brief The segment should be handed over by value.
-     *
-     * Suggestion: Call the constructor like this: `Ring myring(std::move(segment));`
-     */
-    Ring(RingSegment first_segment);
+    /// first and last nodes of the member ways, sorted by way ID
+    std::vector<WayEnds> m_way_ends;
 
-    /**
-     * Check if the segment matches to this ring.
-     *
-     * \param segment segment to be checked
-     *
-     * \returns true if it matches
-     */
-    bool check_match(RingSegment& segment);
+    /// rings of the current relation, reused for all relations
+    RingAssembler m_ring_assembler;
 
     /**
-     * Add a segment to this ring if it matches.
+     * Get the first and last node of a member way.
      *
-     * \param segment segment to be added
-     */
-    void append(RingSegment&& segment);
-
-    /**
-     * Get number of member ways of this ring.
+     * \returns nullptr if the way has not been read
      */
-    size_t size();
+    const WayEnds* find_way_ends(const osmium::object_id_type way_id) const;
 
     /**
-     * Check if the ring is already closed
+     * Assemble the rings of a relation and remember the ways of small rings.
+     *
+     * \param index position of the relation in m_first_members
      */
-    bool closed();
+    void complete_relation(const size_t index);
 
+public:
     /**
-     * Get ID of the first way.
+     * \param treat_as_rings_way set to add the member ways of small rings to
+     * \param member_ways sorted IDs of the member ways of all relations of interest, it has to be
+     * complete before the second pass starts
      */
-    osmium::object_id_type front_way_ref();
+    BoundaryRelationCollector(WayIdSet& treat_as_rings_way, const WayIdSet& member_ways);
 
     /**
-     * Get ID of the last way.
+     * This method decides which relations we're interested in.
      */
-    osmium::object_id_type back_way_ref();
-};
+    static bool keep_relation(const osmium::Relation&);
 
-/**
- * \brief Relation collector for boundary relations.
- *
- * This collector collects boundary relations and tries to assemble rings in order to
- * detect which rings have only one or two members.
- */
-class BoundaryRelationCollector : public osmium::relations::Collector<BoundaryRelationCollector,
-true, true, true> {
     /**
-     * Set to track the IDs of the member ways of small rings (i.e. rings with only one or two members).
+     * Remember the member ways of a relation of interest (first pass).
      */
-    std::unordered_set<osmium::object_id_type>& m_treat_as_rings_way;
-
-    /** Helper to retrieve relation member */
-    osmium::Way* get_member_way(size_t offset) const;
-
-public:
-    BoundaryRelationCollector(std::unordered_set<osmium::object_id_type>& treat_as_rings_way);
+    void relation(const osmium::Relation& relation);
 
     /**
-     * This method decides which relations we're interested in, and
-     * instructs Osmium to collect their members for us.
+     * Remember the first and last node of a member way (second pass).
      */
-    bool keep_relation(const osmium::Relation&) const;
+    void way(const osmium::Way& way);
 
     /**
-     * Tells Osmium which members to keep for a relation of interest.
+     * Assemble the rings of all relations. Has to be called after the second pass.
      */
-    bool keep_member(const osmium::relations::RelationMeta& relation_meta, const osmium::RelationMember& member) const;
+    void complete_relations();
 
     /**
-     * Called by Osmium when a relation has been fully read (i.e. all
-     * members are present)
+     * Get number of bytes used by the collector.
      */
-    void complete_relation(osmium::relations::RelationMeta& relation_meta);
+    size_t used_memory() const;
 };
 
 
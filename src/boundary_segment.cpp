@@ -16,27 +16,27 @@ BoundarySegment::BoundarySegment(const osmium::Location& location1, const osmium
         m_start_offset(first() == location1 ? start_offset : end_offset),
         m_end_offset(first() == location1 ? end_offset : start_offset) {}
 
-bool BoundarySegment::get_reverse() {
+bool BoundarySegment::get_reverse() const {
     return m_reverse;
 }
 
-size_t BoundarySegment::get_start_offset() {
+size_t BoundarySegment::get_start_offset() const {
     return m_reverse ? m_end_offset : m_start_offset;
 }
 
-size_t BoundarySegment::get_end_offset() {
+size_t BoundarySegment::get_end_offset() const {
     return m_reverse ? m_start_offset : m_end_offset;
 }
 
-size_t BoundarySegment::omitted_count() {
-    return m_end_offset - m_start_offset - 1;
+size_t BoundarySegment::omitted_count() const {
+    return get_end_offset() - get_start_offset() - 1;
 }
 
-osmium::object_id_type BoundarySegment::id() {
+osmium::object_id_type BoundarySegment::id() const {
     return m_way_id;
 }
 
-bool BoundarySegment::active() {
+bool BoundarySegment::active() const {
     return !m_deactivated;
 }
 
@@ -42,34 +42,34 @@ public:
     explicit BoundarySegment(const osmium::Location& location1, const osmium::Location& location2,
             osmium::object_id_type way_id, size_t start_offset, size_t end_offset);
 
-    bool get_reverse();
+    bool get_reverse() const;
 
     /**
      * \brief Get start ID.
      *
      * Returns start ID and respects #m_reverse.
      */
-    size_t get_start_offset();
+    size_t get_start_offset() const;
 
     /**
      * \brief Get start ID.
      *
      * Returns start ID and respects #m_reverse.
      */
-    size_t get_end_offset();
+    size_t get_end_offset() const;
 
     /**
      * \brief Get number of nodes which are omitted by this segment.
      */
 
-    size_t omitted_count();
+    size_t omitted_count() const;
 
     /**
      * \brief Get way ID.
      */
-    osmium::object_id_type id();
+    osmium::object_id_type id() const;
 
-    bool active();
+    bool active() const;
 
     void deactivate();
 };
@@ -0,0 +1,103 @@
+/*
+ * boundary_segment_store.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include <algorithm>
+#include <numeric>
+#include "boundary_segment_store.hpp"
+
+void BoundarySegmentStore::emplace_back(const osmium::Location& location1, const osmium::Location& location2,
+        osmium::object_id_type way_id, size_t start_offset, size_t end_offset) {
+    // same order of the locations as in osmium::UndirectedSegment
+    const bool reverse = location2 < location1;
+    const osmium::Location& first = reverse ? location2 : location1;
+    const osmium::Location& second = reverse ? location1 : location2;
+    if (size() % 64 == 0) {
+        m_deactivated.push_back(0);
+    }
+    m_x1.push_back(first.x());
+    m_y1.push_back(first.y());
+    m_x2.push_back(second.x());
+    m_y2.push_back(second.y());
+    m_way_ids.push_back(way_id);
+    m_start_offsets.push_back(static_cast<uint32_t>(start_offset));
+    m_end_offsets.push_back(static_cast<uint32_t>(end_offset));
+}
+
+void BoundarySegmentStore::reserve(const size_t size) {
+    m_x1.reserve(size);
+    m_y1.reserve(size);
+    m_x2.reserve(size);
+    m_y2.reserve(size);
+    m_way_ids.reserve(size);
+    m_start_offsets.reserve(size);
+    m_end_offsets.reserve(size);
+    m_deactivated.reserve((size + 63) / 64);
+}
+
+void BoundarySegmentStore::append(const BoundarySegmentStore& other) {
+    const size_t offset = size();
+    m_x1.insert(m_x1.end(), other.m_x1.begin(), other.m_x1.end());
+    m_y1.insert(m_y1.end(), other.m_y1.begin(), other.m_y1.end());
+    m_x2.insert(m_x2.end(), other.m_x2.begin(), other.m_x2.end());
+    m_y2.insert(m_y2.end(), other.m_y2.begin(), other.m_y2.end());
+    m_way_ids.insert(m_way_ids.end(), other.m_way_ids.begin(), other.m_way_ids.end());
+    m_start_offsets.insert(m_start_offsets.end(), other.m_start_offsets.begin(), other.m_start_offsets.end());
+    m_end_offsets.insert(m_end_offsets.end(), other.m_end_offsets.begin(), other.m_end_offsets.end());
+    // The bitmap cannot be copied because the segments are not aligned to 64 bit words.
+    m_deactivated.resize((size() + 63) / 64, 0);
+    for (size_t i = 0; i < other.size(); ++i) {
+        if (!other.active(i)) {
+            deactivate(offset + i);
+        }
+    }
+}
+
+void BoundarySegmentStore::sort() {
+    std::vector<size_t> permutation (size());
+    std::iota(permutation.begin(), permutation.end(), 0);
+    std::sort(permutation.begin(), permutation.end(), [this](const size_t a, const size_t b) {
+        if (m_x1[a] != m_x1[b]) {
+            return m_x1[a] < m_x1[b];
+        }
+        if (m_y1[a] != m_y1[b]) {
+            return m_y1[a] < m_y1[b];
+        }
+        if (m_x2[a] != m_x2[b]) {
+            return m_x2[a] < m_x2[b];
+        }
+        return m_y2[a] < m_y2[b];
+    });
+    std::vector<uint64_t> deactivated (m_deactivated.size(), 0);
+    for (size_t i = 0; i < permutation.size(); ++i) {
+        if (!active(permutation[i])) {
+            deactivated[i / 64] |= static_cast<uint64_t>(1) << (i % 64);
+        }
+    }
+    m_deactivated.swap(deactivated);
+    permute(m_x1, permutation);
+    permute(m_y1, permutation);
+    permute(m_x2, permutation);
+    permute(m_y2, permutation);
+    permute(m_way_ids, permutation);
+    permute(m_start_offsets, permutation);
+    permute(m_end_offsets, permutation);
+}
+
+BoundarySegment BoundarySegmentStore::at(const size_t index) const {
+    BoundarySegment segment {first(index), second(index), m_way_ids.at(index), m_start_offsets[index],
+        m_end_offsets[index]};
+    if (!active(index)) {
+        segment.deactivate();
+    }
+    return segment;
+}
+
+size_t BoundarySegmentStore::used_memory() const {
+    return (m_x1.capacity() + m_y1.capacity() + m_x2.capacity() + m_y2.capacity()) * sizeof(int32_t)
+            + m_way_ids.capacity() * sizeof(osmium::object_id_type)
+            + (m_start_offsets.capacity() + m_end_offsets.capacity()) * sizeof(uint32_t)
+            + m_deactivated.capacity() * sizeof(uint64_t);
+}
@@ -0,0 +1,164 @@
+/*
+ * boundary_segment_store.hpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#ifndef SRC_BOUNDARY_SEGMENT_STORE_HPP_
+#define SRC_BOUNDARY_SEGMENT_STORE_HPP_
+
+#include <cstdint>
+#include <vector>
+#include <osmium/osm/location.hpp>
+#include <osmium/osm/segment.hpp>
+#include <osmium/osm/types.hpp>
+#include "boundary_segment.hpp"
+
+/**
+ * \brief Container of all segments of the simplified boundaries.
+ *
+ * The segments are stored column by column (structure of arrays). Searching for intersections
+ * mostly reads the coordinates of the segments. They are therefore kept in separate arrays
+ * which can be read without loading the way IDs and offsets into the cache, too.
+ *
+ * Like osmium::UndirectedSegment, the first location of a segment is the smaller one. The
+ * offsets are always stored in the order of the way, i.e. the start offset is smaller than
+ * the end offset.
+ */
+class BoundarySegmentStore {
+    std::vector<int32_t> m_x1;
+    std::vector<int32_t> m_y1;
+    std::vector<int32_t> m_x2;
+    std::vector<int32_t> m_y2;
+
+    /// IDs of the OSM ways the segments belong to
+    std::vector<osmium::object_id_type> m_way_ids;
+
+    /// offset of the start node from start of the way (number of nodes)
+    std::vector<uint32_t> m_start_offsets;
+
+    /// offset of the end node from start of the way (number of nodes)
+    std::vector<uint32_t> m_end_offsets;
+
+    /// bitmap of the segments which have been deactivated
+    std::vector<uint64_t> m_deactivated;
+
+    template <typename T>
+    static void permute(std::vector<T>& column, const std::vector<size_t>& permutation) {
+        std::vector<T> result;
+        result.reserve(column.size());
+        for (const size_t i : permutation) {
+            result.push_back(column[i]);
+        }
+        column.swap(result);
+    }
+
+public:
+    /**
+     * Add a segment.
+     *
+     * The two locations may be given in any order.
+     */
+    void emplace_back(const osmium::Location& location1, const osmium::Location& location2,
+            osmium::object_id_type way_id, size_t start_offset, size_t end_offset);
+
+    size_t size() const {
+        return m_x1.size();
+    }
+
+    bool empty() const {
+        return m_x1.empty();
+    }
+
+    void reserve(const size_t size);
+
+    /**
+     * Add all segments of another store to the end of this store.
+     */
+    void append(const BoundarySegmentStore& other);
+
+    /**
+     * Sort the segments by their first location and then by their second location.
+     *
+     * This is the same order as the one of osmium::UndirectedSegment.
+     */
+    void sort();
+
+    /**
+     * Get a copy of a segment.
+     */
+    BoundarySegment at(const size_t index) const;
+
+    osmium::Location first(const size_t index) const {
+        return osmium::Location{m_x1[index], m_y1[index]};
+    }
+
+    osmium::Location second(const size_t index) const {
+        return osmium::Location{m_x2[index], m_y2[index]};
+    }
+
+    osmium::Segment segment(const size_t index) const {
+        return osmium::Segment{first(index), second(index)};
+    }
+
+    int32_t x_min(const size_t index) const {
+        return m_x1[index];
+    }
+
+    int32_t x_max(const size_t index) const {
+        return m_x2[index];
+    }
+
+    int32_t y_min(const size_t index) const {
+        return m_y1[index] < m_y2[index] ? m_y1[index] : m_y2[index];
+    }
+
+    int32_t y_max(const size_t index) const {
+        return m_y1[index] < m_y2[index] ? m_y2[index] : m_y1[index];
+    }
+
+    /**
+     * Check if two segments have the same locations.
+     */
+    bool same_locations(const size_t index1, const size_t index2) const {
+        return m_x1[index1] == m_x1[index2] && m_y1[index1] == m_y1[index2]
+                && m_x2[index1] == m_x2[index2] && m_y2[index1] == m_y2[index2];
+    }
+
+    /**
+     * \brief Get way ID.
+     */
+    osmium::object_id_type way_id(const size_t index) const {
+        return m_way_ids[index];
+    }
+
+    size_t start_offset(const size_t index) const {
+        return m_start_offsets[index];
+    }
+
+    size_t end_offset(const size_t index) const {
+        return m_end_offsets[index];
+    }
+
+    /**
+     * \brief Get number of nodes which are omitted by this segment.
+     */
+    size_t omitted_count(const size_t index) const {
+        return m_end_offsets[index] - m_start_offsets[index] - 1;
+    }
+
+    bool active(const size_t index) const {
+        return (m_deactivated[index / 64] & (static_cast<uint64_t>(1) << (index % 64))) == 0;
+    }
+
+    void deactivate(const size_t index) {
+        m_deactivated[index / 64] |= static_cast<uint64_t>(1) << (index % 64);
+    }
+
+    /**
+     * Get the number of bytes used by the store.
+     */
+    size_t used_memory() const;
+};
+
+#endif /* SRC_BOUNDARY_SEGMENT_STORE_HPP_ */
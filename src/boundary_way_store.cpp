@@ -0,0 +1,86 @@
+/*
+ * boundary_way_store.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include <algorithm>
+#include "boundary_relation_collector.hpp"
+#include "boundary_way_store.hpp"
+
+constexpr size_t BoundaryWayStore::BUFFER_SIZE;
+
+BoundaryWayStore::BoundaryWayStore(const osmium::io::File& input_file, const bool boundaries_only) :
+        m_input_file(input_file),
+        m_way_buffers(),
+        m_boundaries_only(boundaries_only),
+        m_member_ways() { }
+
+bool BoundaryWayStore::pass_relation(const osmium::Relation& relation) const {
+    return !m_boundaries_only || BoundaryRelationCollector::keep_relation(relation);
+}
+
+osmium::memory::Buffer& BoundaryWayStore::way_buffer(const size_t item_size) {
+    if (m_way_buffers.empty() || m_way_buffers.back().committed() + item_size > BUFFER_SIZE) {
+        // Very long ways might not fit into an empty buffer. Therefore the buffer may grow.
+        m_way_buffers.emplace_back(BUFFER_SIZE, osmium::memory::Buffer::auto_grow::yes);
+    }
+    return m_way_buffers.back();
+}
+
+void BoundaryWayStore::way(const osmium::Way& way) {
+    if (!m_member_ways.contains(way.id(), m_member_ways_position)) {
+        ++m_other_way_count;
+        return;
+    }
+    osmium::memory::Buffer& buffer = way_buffer(way.byte_size());
+    buffer.add_item(way);
+    buffer.commit();
+    ++m_way_count;
+    for (const osmium::NodeRef& nd_ref : way.nodes()) {
+        m_max_node_id = std::max(m_max_node_id, nd_ref.ref());
+    }
+}
+
+void BoundaryWayStore::relation(const osmium::Relation& relation) {
+    if (!BoundaryRelationCollector::keep_relation(relation)) {
+        return;
+    }
+    for (const osmium::RelationMember& member : relation.members()) {
+        if (member.type() == osmium::item_type::way) {
+            m_member_ways.insert(member.ref());
+        }
+    }
+}
+
+void BoundaryWayStore::finish_relations() {
+    m_member_ways.sort();
+}
+
+const WayIdSet& BoundaryWayStore::member_ways() const {
+    return m_member_ways;
+}
+
+std::vector<osmium::memory::Buffer>& BoundaryWayStore::way_buffers() {
+    return m_way_buffers;
+}
+
+size_t BoundaryWayStore::way_count() const {
+    return m_way_count;
+}
+
+size_t BoundaryWayStore::other_way_count() const {
+    return m_other_way_count;
+}
+
+osmium::object_id_type BoundaryWayStore::max_node_id() const {
+    return m_max_node_id;
+}
+
+size_t BoundaryWayStore::used_memory() const {
+    size_t result = m_member_ways.used_memory();
+    for (const osmium::memory::Buffer& buffer : m_way_buffers) {
+        result += buffer.committed();
+    }
+    return result;
+}
@@ -0,0 +1,219 @@
+/*
+ * boundary_way_store.hpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#ifndef SRC_BOUNDARY_WAY_STORE_HPP_
+#define SRC_BOUNDARY_WAY_STORE_HPP_
+
+#include <atomic>
+#include <future>
+#include <vector>
+#include <osmium/handler.hpp>
+#include <osmium/io/file.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/memory/buffer.hpp>
+#include <osmium/osm/entity_bits.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/osm/relation.hpp>
+#include <osmium/visitor.hpp>
+#include "relation_reader.hpp"
+#include "way_id_set.hpp"
+
+/**
+ * \brief In-memory copy of the member ways of the boundary relations of the input file.
+ *
+ * The simplification needs to read the boundary ways many times (simplification, every iteration
+ * of the intersection check and the final pass). Decoding the input file again for every pass is
+ * much more expensive than keeping the ways (ID, tags, node references with their locations) in
+ * memory.
+ *
+ * The member ways of the boundary relations are collected from the relations passed to relation()
+ * (first pass). Only these ways are kept by way() (second pass). All other ways are still
+ * simplified and written but they are read from the input file again by apply_other_ways()
+ * because an unfiltered input file might contain far more of them. Inputs which only consist of
+ * boundaries are therefore read only twice. Relations are not stored, apply_relations() reads
+ * them from the input file again.
+ *
+ * If the store is restricted to boundaries, the other ways are skipped completely and only the
+ * relations which are boundaries are passed on.
+ *
+ * Ways are stored in a list of buffers instead of a single auto-growing buffer. A single buffer
+ * would be copied every time it has to grow and would temporarily need twice the memory.
+ */
+class BoundaryWayStore : public osmium::handler::Handler {
+    osmium::io::File m_input_file;
+
+    std::vector<osmium::memory::Buffer> m_way_buffers;
+
+    size_t m_way_count = 0;
+
+    /// number of ways which are not a member of any boundary relation
+    size_t m_other_way_count = 0;
+
+    /// skip all ways which are not a member of any boundary relation and all other relations
+    bool m_boundaries_only;
+
+    /// IDs of the member ways of the boundary relations
+    WayIdSet m_member_ways;
+
+    /// position in m_member_ways where the lookup of the next way passed to way() starts
+    size_t m_member_ways_position = 0;
+
+    /// largest ID of the nodes referenced by the stored ways
+    osmium::object_id_type m_max_node_id = 0;
+
+    /**
+     * Get a buffer which has enough space left for an item of the given size.
+     */
+    osmium::memory::Buffer& way_buffer(const size_t item_size);
+
+public:
+    /// size of a single way buffer
+    static constexpr size_t BUFFER_SIZE = 16 * 1024 * 1024;
+
+    /**
+     * \param input_file file to read the other ways and the relations from
+     * \param boundaries_only skip all ways which are not a member of any boundary relation and all
+     * relations which are not boundaries
+     */
+    explicit BoundaryWayStore(const osmium::io::File& input_file, const bool boundaries_only = false);
+
+    /**
+     * Check if a relation should be passed on by apply_relations().
+     */
+    bool pass_relation(const osmium::Relation& relation) const;
+
+    /**
+     * Copy a way into the store if it is a member of a boundary relation.
+     */
+    void way(const osmium::Way& way);
+
+    /**
+     * Remember the member ways of a boundary relation.
+     */
+    void relation(const osmium::Relation& relation);
+
+    /**
+     * Sort the IDs of the member ways. This has to be called after all relations have been passed
+     * to relation() and before the first way is passed to way().
+     */
+    void finish_relations();
+
+    /**
+     * Feed all stored ways to the handlers (in the order they have been read).
+     */
+    template <typename... THandlers>
+    void apply_ways(THandlers&&... handlers) {
+        for (osmium::memory::Buffer& buffer : m_way_buffers) {
+            osmium::apply(buffer, handlers...);
+        }
+    }
+
+    /**
+     * Read the ways which are not a member of any boundary relation from the input file and feed
+     * them to the handlers. The input file is not read if there are no such ways or if the store is
+     * restricted to boundaries.
+     */
+    template <typename... THandlers>
+    void apply_other_ways(THandlers&&... handlers) {
+        if (m_boundaries_only || m_other_way_count == 0) {
+            return;
+        }
+        osmium::io::Reader reader{m_input_file, osmium::osm_entity_bits::way};
+        size_t position = 0;
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            osmium::memory::Buffer other_ways {buffer.committed(), osmium::memory::Buffer::auto_grow::yes};
+            for (auto it = buffer.cbegin<osmium::Way>(); it != buffer.cend<osmium::Way>(); ++it) {
+                if (!m_member_ways.contains(it->id(), position)) {
+                    other_ways.add_item(*it);
+                    other_ways.commit();
+                }
+            }
+            osmium::apply(other_ways, handlers...);
+        }
+        reader.close();
+    }
+
+    /**
+     * Call a function for every way buffer using multiple threads.
+     *
+     * Every buffer is processed by a single thread. The function has to be thread-safe.
+     *
+     * \param threads number of threads
+     * \param function function to be called with the position of the buffer in way_buffers() and the buffer
+     */
+    template <typename TFunction>
+    void for_each_way_buffer(const unsigned int threads, TFunction&& function) {
+        std::atomic<size_t> next_buffer {0};
+        auto worker = [this, &function, &next_buffer]() {
+            for (size_t b = next_buffer++; b < m_way_buffers.size(); b = next_buffer++) {
+                function(b, m_way_buffers[b]);
+            }
+        };
+        // std::async is used because it passes exceptions of the worker threads to this thread.
+        std::vector<std::future<void>> workers;
+        for (unsigned int t = 0; t < threads; ++t) {
+            workers.push_back(std::async(std::launch::async, worker));
+        }
+        for (std::future<void>& w : workers) {
+            w.get();
+        }
+    }
+
+    /**
+     * Read all relations from the input file and feed them to the handlers. Only the relation
+     * section of sorted PBF files is read. If the store is restricted to boundaries, only boundary
+     * relations are passed on.
+     */
+    template <typename... THandlers>
+    void apply_relations(THandlers&&... handlers) {
+        RelationReader reader{m_input_file};
+        while (osmium::memory::Buffer buffer = reader.read()) {
+            if (!m_boundaries_only) {
+                osmium::apply(buffer, handlers...);
+                continue;
+            }
+            osmium::memory::Buffer boundaries {buffer.committed(), osmium::memory::Buffer::auto_grow::yes};
+            for (auto it = buffer.cbegin<osmium::Relation>(); it != buffer.cend<osmium::Relation>(); ++it) {
+                if (pass_relation(*it)) {
+                    boundaries.add_item(*it);
+                    boundaries.commit();
+                }
+            }
+            osmium::apply(boundaries, handlers...);
+        }
+        reader.close();
+    }
+
+    /**
+     * Get the sorted IDs of the member ways of the boundary relations. The set is complete after
+     * finish_relations() has been called.
+     */
+    const WayIdSet& member_ways() const;
+
+    /**
+     * Get the buffers the ways are stored in.
+     */
+    std::vector<osmium::memory::Buffer>& way_buffers();
+
+    size_t way_count() const;
+
+    /**
+     * Get the number of ways which are not a member of any boundary relation.
+     */
+    size_t other_way_count() const;
+
+    /**
+     * Get the largest ID of the nodes referenced by the stored ways.
+     */
+    osmium::object_id_type max_node_id() const;
+
+    /**
+     * Get number of bytes used by the stored ways and the IDs of the member ways.
+     */
+    size_t used_memory() const;
+};
+
+#endif /* SRC_BOUNDARY_WAY_STORE_HPP_ */
@@ -6,6 +6,7 @@
  */
 
 #include <osmium/geom/util.hpp>
+#include <algorithm>
 #include <iostream>
 #include "distance_sphere_plain.hpp"
 
@@ -63,8 +64,40 @@ double DistanceSpherePlain::distance_from_line_less_trig(const osmium::Location&
     return osmium::geom::haversine::distance(t.location(), point);
 }
 
+GreatCircle::GreatCircle(const Vector3D& start, const Vector3D& end) :
+    m_start(start),
+    m_normal(start.cross_product(end)),
+    m_degenerated(false) {
+    const double length = m_normal.vector_length();
+    if (length == 0) {
+        m_degenerated = true;
+    } else {
+        m_normal /= length;
+    }
+}
+
+double GreatCircle::distance(const Vector3D& point) const {
+    if (m_degenerated) {
+        // angle between the two vectors
+        return std::atan2(m_start.cross_product(point).vector_length(), m_start.dot_product(point))
+                * osmium::geom::haversine::EARTH_RADIUS_IN_METERS;
+    }
+    // The dot product might be slightly larger than 1 due to rounding errors.
+    const double sin_angle = std::max(-1.0, std::min(1.0, m_normal.dot_product(point)));
+    return std::abs(std::asin(sin_angle)) * osmium::geom::haversine::EARTH_RADIUS_IN_METERS;
+}
+
 double DistanceSpherePlain::distance_from_line_sphere(const osmium::Location& start,
         const osmium::Location& end, const osmium::Location& point) {
+    if (start == end) {
+        return osmium::geom::haversine::distance(start, point);
+    }
+    const GreatCircle circle {Vector3D::unit_vector(start), Vector3D::unit_vector(end)};
+    return circle.distance(Vector3D::unit_vector(point));
+}
+
+double DistanceSpherePlain::distance_from_line_bearings(const osmium::Location& start,
+        const osmium::Location& end, const osmium::Location& point) {
     // http://www.movable-type.co.uk/scripts/latlong.html
     // If the coordinates of start and end node are equal (i.e. closed ring), the distance can be calculated
     // directly from the coordinates.
@@ -84,5 +117,5 @@ double DistanceSpherePlain::bearing(const osmium::Location& start, const osmium:
     // lon and lat of start and end node
     double lat1 = osmium::geom::deg_to_rad(start.lat());
     double lat2 = osmium::geom::deg_to_rad(end.lat());
-    return std::atan2(sin(d_lon) * cos(lat2), cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2 * cos(d_lon)));
+    return std::atan2(sin(d_lon) * cos(lat2), cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(d_lon));
 }
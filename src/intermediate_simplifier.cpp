@@ -6,110 +6,118 @@
  */
 
 #include "intermediate_simplifier.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <future>
 #include <iostream>
+#include "sweep_line.hpp"
 
-osmium::Location IntermediateSimplifier::intersection(const osmium::Segment& s1, const osmium::Segment&s2) {
+int IntermediateSimplifier::orientation(const osmium::Location& a, const osmium::Location& b,
+        const osmium::Location& c) {
+    // Both products fit into 64 bit integers but their difference might not. Therefore they are compared.
+    const int64_t lhs = (static_cast<int64_t>(b.x()) - a.x()) * (static_cast<int64_t>(c.y()) - a.y());
+    const int64_t rhs = (static_cast<int64_t>(b.y()) - a.y()) * (static_cast<int64_t>(c.x()) - a.x());
+    return (lhs > rhs) - (lhs < rhs);
+}
+
+osmium::Location IntermediateSimplifier::intersection(const osmium::Segment& s1, const osmium::Segment&s2) const {
     if (s1.first()  == s2.first()  ||
         s1.first()  == s2.second() ||
         s1.second() == s2.first()  ||
         s1.second() == s2.second()) {
         return osmium::Location();
     }
+    const osmium::Location a = std::min(s1.first(), s1.second());
+    const osmium::Location b = std::max(s1.first(), s1.second());
+    const osmium::Location c = std::min(s2.first(), s2.second());
+    const osmium::Location d = std::max(s2.first(), s2.second());
 
-    double t1x = s1.second().lon() - s1.first().lon();
-    double t1y = s1.second().lat() - s1.first().lat();
-    double t2x = s2.second().lon() - s2.first().lon();
-    double t2y = s2.second().lat() - s2.first().lat();
-    double p11x = s1.first().lon();
-    double p11y = s1.first().lat();
-    double p21x = s2.first().lon();
-    double p21y = s2.first().lat();
-
-    double s;
-    double r;
-    if (t1x == 0) {
-        s = (p11x - p21x) / t2x; // kx = p21x + s * t2x
-        r = (p21y + s * t2y - p11y) / t1y;
-    } else if (t1y / t1x == t2y / t2x) {
-        if ((p21x - p11x) / t2x == (p21y - p11y) / t2y) {
-            // Every point on s1 is also a point on s2.
-            return osmium::Location(s1.first());
-        } else {
-            // They are parallel and not intersecting.
-            return osmium::Location();
+    const int o1 = orientation(a, b, c);
+    const int o2 = orientation(a, b, d);
+    if (o1 == 0 && o2 == 0) {
+        // Both segments are on the same line. They overlap if one starts before the other one ends.
+        const osmium::Location overlap_start = std::max(a, c);
+        if (overlap_start <= std::min(b, d)) {
+            return overlap_start;
         }
-    } else {
-        s = (p11y - p21y + ((p21x - p11x) * (t1y / t1x)))
-                / (t2y - ((t2x * t1y) / t1x));
-        r = (p21x - p11x + s * t2x) / t1x;
+        return osmium::Location();
     }
-    // we have to neglet a small error r and s to circumvent some numerical problems
-    // If the base line is 100 km long, this will result in an error of 5 mm.
-    if (r >= -0.0000001 && r <= 1.0000001 && s >= -0.0000001 && s <= 1.0000001) {
-        return osmium::Location(p11x + r * t1x, p11y + r * t1y);
+    if (o1 * o2 > 0) {
+        // c and d are on the same side of s1
+        return osmium::Location();
     }
-    return osmium::Location();
-}
-
-bool IntermediateSimplifier::outside_x_range(const osmium::UndirectedSegment& s1, const osmium::UndirectedSegment& s2) {
-    if (s1.first().x() > s2.second().x()) {
-        return true;
+    const int o3 = orientation(c, d, a);
+    const int o4 = orientation(c, d, b);
+    if (o3 * o4 > 0) {
+        return osmium::Location();
     }
-    return false;
-}
-
-bool IntermediateSimplifier::y_range_overlap(const osmium::UndirectedSegment& s1, const osmium::UndirectedSegment& s2) {
-    const int tmin = s1.first().y() < s1.second().y() ? s1.first().y( ) : s1.second().y();
-    const int tmax = s1.first().y() < s1.second().y() ? s1.second().y() : s1.first().y();
-    const int omin = s2.first().y() < s2.second().y() ? s2.first().y()  : s2.second().y();
-    const int omax = s2.first().y() < s2.second().y() ? s2.second().y() : s2.first().y();
-    if (tmin > omax || omin > tmax) {
-        return false;
+    // If one end of a segment is located on the other segment, it is the intersection.
+    if (o1 == 0) {
+        return c;
+    }
+    if (o2 == 0) {
+        return d;
+    }
+    if (o3 == 0) {
+        return a;
     }
-    return true;
+    if (o4 == 0) {
+        return b;
+    }
+    // The segments cross each other. This is the only case which needs floating point arithmetics.
+    const double t1x = static_cast<double>(b.x()) - a.x();
+    const double t1y = static_cast<double>(b.y()) - a.y();
+    const double t2x = static_cast<double>(d.x()) - c.x();
+    const double t2y = static_cast<double>(d.y()) - c.y();
+    const double r = ((static_cast<double>(c.x()) - a.x()) * t2y - (static_cast<double>(c.y()) - a.y()) * t2x)
+            / (t1x * t2y - t1y * t2x);
+    return osmium::Location(static_cast<int32_t>(std::llround(a.x() + r * t1x)),
+            static_cast<int32_t>(std::llround(a.y() + r * t1y)));
 }
 
-IntermediateSimplifier::IntermediateSimplifier(double epsilon, ErrorsMap& error_segments, std::vector<BoundarySegment>& all_segments,
-        KeepNodesMap& keep_nodes, osmium::util::VerboseOutput& vout) :
+IntermediateSimplifier::IntermediateSimplifier(double epsilon, ErrorsMap& error_segments, BoundarySegmentStore& all_segments,
+        KeepNodesMap& keep_nodes, osmium::util::VerboseOutput& vout, const unsigned int threads) :
     AbstractWaySimplifier(epsilon),
     m_error_segments(error_segments),
     m_all_segments(all_segments),
     m_kept_nodes(keep_nodes),
-    m_vout(vout) { }
+    m_vout(vout),
+    m_threads(threads) { }
 
-std::vector<NoSimplifySegment*> IntermediateSimplifier::sort_no_simplify_segments(osmium::object_id_type way_id) {
-    std::pair<ErrorsMap::iterator, ErrorsMap::iterator> it_range = m_error_segments.equal_range(way_id);
-    std::vector<NoSimplifySegment*> ordered;
+void IntermediateSimplifier::collect_no_simplify_segments(osmium::object_id_type way_id) {
+    m_no_simplify.clear();
+    std::pair<ErrorsMap::iterator, ErrorsMap::iterator> it_range = m_error_segments.equal_range(way_id,
+            m_error_segments_position);
+    // The segments are sorted by their offsets already. Duplicates are therefore neighbours.
     for (ErrorsMap::iterator it = it_range.first; it != it_range.second; it++) {
         if (!(it->second.m_deactivated)) {
-            ordered.push_back(&(it->second));
+            if (m_no_simplify.empty() || !NoSimplifySegment::EqualityComparator()(m_no_simplify.back(), &(it->second))) {
+                m_no_simplify.push_back(&(it->second));
+            }
             it->second.m_deactivated = true;
         }
     }
-    // sort and remove duplicates
-    std::sort(ordered.begin(), ordered.end(), NoSimplifySegment::LessThanComparator());
-    ordered.erase(std::unique(ordered.begin(), ordered.end(), NoSimplifySegment::EqualityComparator()), ordered.end());
-    return ordered;
 }
 
 void IntermediateSimplifier::improve_simplification(const osmium::Way& way) {
-    std::vector<NoSimplifySegment*> ordered = sort_no_simplify_segments(way.id());
+    collect_no_simplify_segments(way.id());
+    const std::vector<NoSimplifySegment*>& ordered = m_no_simplify;
     if (ordered.size() == 0 || ordered.size() == way.nodes().size() - 1) {
         // every segment intersects, nothing to simplify
         // OR: no segment intersects
         return;
     }
-    // vector for kept node references; entrys which are nullptr mean that we discard these nodes
-    std::vector<const osmium::NodeRef*> kept_node_refs {way.nodes().size(), nullptr};
+    start_way(way.nodes());
     for (NoSimplifySegment* segment : ordered) {
         if (segment->m_end_offset - segment->m_start_offset > 1) {
             // ignore if the intersection is at the beginning of the segment or the segment cannot be shortened any more
             // get node with largest distance for this segment
             size_t offset_largest = 0;
             double distance_max = 0;
+            const GreatCircle circle {m_unit_vectors[segment->m_start_offset], m_unit_vectors[segment->m_end_offset]};
             for (size_t i = segment->m_start_offset + 1; i < segment->m_end_offset; ++i) {
-                double distance = m_distance_calculator.distance_from_line_sphere(way.nodes()[segment->m_start_offset].location(),
-                        way.nodes()[segment->m_end_offset].location(), way.nodes()[i].location());
+                double distance = circle.distance(m_unit_vectors[i]);
                 // We have to use >=, not > because otherwise offset_largest will be 0 at the end of the loop
                 // if the segment is straight.
                 if (distance >= distance_max) {
@@ -122,7 +130,7 @@ void IntermediateSimplifier::improve_simplification(const osmium::Way& way) {
                     segment->m_start_offset, offset_largest);
             m_all_segments.emplace_back(way.nodes()[offset_largest].location(), way.nodes()[segment->m_end_offset].location(), way.id(),
                     offset_largest, segment->m_end_offset);
-            m_kept_nodes.insert(std::make_pair<osmium::object_id_type, size_t>(way.id(), static_cast<size_t>(offset_largest)));
+            m_kept_nodes.insert(way.id(), offset_largest);
         } else {
             m_all_segments.emplace_back(way.nodes()[segment->m_start_offset].location(), way.nodes()[segment->m_end_offset].location(), way.id(),
                                 segment->m_start_offset, segment->m_end_offset);
@@ -134,54 +142,185 @@ void IntermediateSimplifier::way(const osmium::Way& way) {
     improve_simplification(way);
 }
 
-bool IntermediateSimplifier::recheck_intersections() {
-    // code copied from osmcoastline by Jochen Topf, GPL license
-    m_vout << "Sort segments ...\n";
-    std::sort(m_all_segments.begin(), m_all_segments.end());
-    bool intersection_found = false;
-    m_vout << "Looking for intersections ...\n";
-    for (std::vector<BoundarySegment>::iterator it1 = m_all_segments.begin(); it1 != m_all_segments.end()-1; ++it1) {
-        BoundarySegment& s1 = *it1;
-        if (!s1.active()) {
-            continue;
+void IntermediateSimplifier::check_pair(const size_t index1, const size_t index2,
+        std::vector<SegmentIntersection>& intersections) const {
+    if (m_all_segments.same_locations(index1, index2)) {
+        // At least one of the segments must not be an unsimplified segment.
+        if (m_all_segments.omitted_count(index1) > 0 || m_all_segments.omitted_count(index2) > 0) {
+            intersections.emplace_back(index1, index2, m_all_segments.first(index1));
         }
-        for (std::vector<BoundarySegment>::iterator it2 = it1 + 1; it2 != m_all_segments.end(); ++it2) {
-            BoundarySegment& s2 = *it2;
-            if (!s2.active()) {
-                continue;
+        return;
+    }
+    osmium::Location i = intersection(m_all_segments.segment(index1), m_all_segments.segment(index2));
+    if (i) {
+        intersections.emplace_back(index1, index2, i);
+    }
+}
+
+void IntermediateSimplifier::report_segment(const size_t index, const osmium::Location& intersection) {
+    if (m_all_segments.active(index)) {
+        m_error_segments.insert(m_all_segments.way_id(index),
+                NoSimplifySegment(m_all_segments.start_offset(index), m_all_segments.end_offset(index), intersection));
+        m_all_segments.deactivate(index);
+    }
+}
+
+bool IntermediateSimplifier::report_intersections(const std::vector<SegmentIntersection>& intersections) {
+    for (const SegmentIntersection& i : intersections) {
+        const size_t s1 = i.m_first;
+        const size_t s2 = i.m_second;
+        if (m_all_segments.same_locations(s1, s2)) {
+            if (m_all_segments.omitted_count(s1) > 0) {
+                report_segment(s1, m_all_segments.first(s1));
             }
-            if (s1 == s2 && (s1.omitted_count() > 0 || s2.omitted_count() > 0)) {
-                // At least one of the segments must not be an unsimplified segment.
-                if (s1.omitted_count() > 0) {
-                    m_error_segments.insert(std::make_pair<osmium::object_id_type, NoSimplifySegment>(s1.id(), NoSimplifySegment(s1, s1.first())));
-                    s1.deactivate();
-                }
-                if (s2.omitted_count() > 0) {
-                    m_error_segments.insert(std::make_pair<osmium::object_id_type, NoSimplifySegment>(s2.id(), NoSimplifySegment(s2, s1.first())));
-                    s2.deactivate();
-                }
-                intersection_found = true;
-            } else if (s1 != s2) {
-                if (outside_x_range(s2, s1)) {
-                    break;
-                }
-                if (y_range_overlap(s1, s2)) {
-                    osmium::Location i = intersection(s1, s2);
-                    if (i) {
-                        // We should not report segments as erroreouns which are only two nodes long. They cannot become better.
-                        if (i != s1.first() && i != s1.second() && s1.omitted_count() > 0) {
-                            m_error_segments.insert(std::make_pair<osmium::object_id_type, NoSimplifySegment>(s1.id(), NoSimplifySegment(s1, i)));
-                            s1.deactivate();
-                        }
-                        if (i != s2.first() && i != s2.second() && s2.omitted_count() > 0) {
-                            m_error_segments.insert(std::make_pair<osmium::object_id_type, NoSimplifySegment>(s2.id(), NoSimplifySegment(s2, i)));
-                            s2.deactivate();
-                        }
-                        intersection_found = true;
-                    }
-                }
+            if (m_all_segments.omitted_count(s2) > 0) {
+                report_segment(s2, m_all_segments.first(s1));
+            }
+        } else {
+            // We should not report segments as erroreouns which are only two nodes long. They cannot become better.
+            if (i.m_location != m_all_segments.first(s1) && i.m_location != m_all_segments.second(s1)
+                    && m_all_segments.omitted_count(s1) > 0) {
+                report_segment(s1, i.m_location);
+            }
+            if (i.m_location != m_all_segments.first(s2) && i.m_location != m_all_segments.second(s2)
+                    && m_all_segments.omitted_count(s2) > 0) {
+                report_segment(s2, i.m_location);
+            }
+        }
+    }
+    return !intersections.empty();
+}
+
+void IntermediateSimplifier::find_intersections(const std::vector<size_t>& order,
+        std::vector<SegmentIntersection>& intersections) const {
+    SweepLine sweep_line {m_all_segments};
+    sweep_line.run(order, [this, &intersections](const size_t index1, const size_t index2) {
+        check_pair(index1, index2, intersections);
+    });
+}
+
+void IntermediateSimplifier::find_intersections_parallel(const std::vector<size_t>& order,
+        std::vector<SegmentIntersection>& intersections) const {
+    // Use more strips than threads because the density of the segments varies a lot.
+    const size_t strip_count = std::min(order.size(), static_cast<size_t>(m_threads) * 8);
+    std::vector<SweepStrip> strips {strip_count};
+    // x coordinate of the western border of each strip
+    std::vector<int32_t> strip_west;
+    for (size_t s = 0; s < strip_count; ++s) {
+        strip_west.push_back(m_all_segments.x_min(order[s * order.size() / strip_count]));
+    }
+    size_t strip = 0;
+    for (size_t pos = 0; pos < order.size(); ++pos) {
+        if (strip + 1 < strip_count && pos == (strip + 1) * order.size() / strip_count) {
+            ++strip;
+            strips[strip].m_first_owned = strips[strip].m_order.size();
+        }
+        const size_t index = order[pos];
+        strips[strip].m_order.push_back(index);
+        // copy the segment into all strips further east it reaches into
+        const int32_t x_max = m_all_segments.x_max(index);
+        for (size_t s = strip + 1; s < strip_count && strip_west[s] <= x_max; ++s) {
+            strips[s].m_order.push_back(index);
+        }
+    }
+
+    std::vector<std::vector<SegmentIntersection>> results {strip_count};
+    std::atomic<size_t> next_strip {0};
+    auto worker = [this, &strips, &results, &next_strip, strip_count]() {
+        for (size_t s = next_strip++; s < strip_count; s = next_strip++) {
+            std::vector<SegmentIntersection>& result = results[s];
+            SweepLine sweep_line {m_all_segments};
+            sweep_line.run(strips[s].m_order, [this, &result](const size_t index1, const size_t index2) {
+                check_pair(index1, index2, result);
+            }, strips[s].m_first_owned);
+            std::vector<size_t>().swap(strips[s].m_order);
+        }
+    };
+    // std::async is used because it passes exceptions of the worker threads to this thread.
+    std::vector<std::future<void>> workers;
+    for (unsigned int t = 0; t < m_threads; ++t) {
+        workers.push_back(std::async(std::launch::async, worker));
+    }
+    for (std::future<void>& w : workers) {
+        w.get();
+    }
+    for (const std::vector<SegmentIntersection>& result : results) {
+        intersections.insert(intersections.end(), result.begin(), result.end());
+    }
+}
+
+void IntermediateSimplifier::find_new_intersections(std::vector<SegmentIntersection>& intersections) const {
+    // new segments against the spatial index
+    for (size_t i = m_checked_count; i < m_all_segments.size(); ++i) {
+        if (!m_all_segments.active(i)) {
+            continue;
+        }
+        m_index.query(SegmentIndex::BBox{m_all_segments, i}, [this, i, &intersections](const size_t other) {
+            if (m_all_segments.active(other)) {
+                check_pair(other, i, intersections);
             }
+        });
+    }
+    // all segments which are not in the index yet against each other, skipping pairs checked before
+    const size_t checked_count = m_checked_count;
+    std::vector<size_t> order = active_segments(m_indexed_count, m_all_segments.size());
+    std::sort(order.begin(), order.end(), [this](const size_t a, const size_t b) {
+        return m_all_segments.x_min(a) < m_all_segments.x_min(b);
+    });
+    SweepLine sweep_line {m_all_segments};
+    sweep_line.run(order,
+            [this, checked_count, &intersections](const size_t index1, const size_t index2) {
+        if (index1 >= checked_count || index2 >= checked_count) {
+            check_pair(index1, index2, intersections);
+        }
+    });
+}
+
+std::vector<size_t> IntermediateSimplifier::active_segments(const size_t begin, const size_t end) const {
+    std::vector<size_t> order;
+    for (size_t i = begin; i < end; ++i) {
+        if (m_all_segments.active(i)) {
+            order.push_back(i);
+        }
+    }
+    return order;
+}
+
+void IntermediateSimplifier::rebuild_index() {
+    m_index.build(m_all_segments, active_segments(0, m_all_segments.size()));
+    m_indexed_count = m_all_segments.size();
+}
+
+bool IntermediateSimplifier::recheck_intersections() {
+    std::vector<SegmentIntersection> intersections;
+    if (m_checked_count == 0) {
+        m_vout << "Sort segments ...\n";
+        m_all_segments.sort();
+        m_vout << "Looking for intersections ...\n";
+        std::vector<size_t> order = active_segments(0, m_all_segments.size());
+        // Splitting the segments into strips only pays off if there are enough segments.
+        if (m_threads > 1 && order.size() > 1000 * m_threads) {
+            find_intersections_parallel(order, intersections);
+        } else {
+            find_intersections(order, intersections);
+        }
+        m_vout << "Building spatial index ...\n";
+        rebuild_index();
+    } else {
+        m_vout << "Looking for intersections of " << m_all_segments.size() - m_checked_count << " new segments ...\n";
+        find_new_intersections(intersections);
+        // Rebuild the index if the segments outside of the index become too many.
+        if (m_all_segments.size() - m_indexed_count > m_index.size() / 8) {
+            m_vout << "Rebuilding spatial index ...\n";
+            rebuild_index();
         }
     }
-    return intersection_found;
+    m_checked_count = m_all_segments.size();
+    std::sort(intersections.begin(), intersections.end(), SegmentIntersection::LessThanComparator());
+    m_vout << "Found " << intersections.size() << " intersections\n";
+    const bool found = report_intersections(intersections);
+    // The next pass over the ways looks the segments and nodes up in the order of the ways.
+    m_error_segments.sort();
+    m_kept_nodes.sort();
+    return found;
 }
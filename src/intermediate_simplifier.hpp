@@ -8,39 +8,180 @@
 #ifndef SRC_INTERMEDIATE_SIMPLIFIER_HPP_
 #define SRC_INTERMEDIATE_SIMPLIFIER_HPP_
 
-#include <unordered_map>
 #include <osmium/util/verbose_output.hpp>
 #include "abstract_way_simplifier.hpp"
+#include "boundary_segment_store.hpp"
 #include "no_simplify_segment.hpp"
+#include "segment_index.hpp"
+
+/**
+ * \brief Pair of segments which intersect each other.
+ */
+struct SegmentIntersection {
+    /// index of the first segment
+    size_t m_first;
+    /// index of the second segment
+    size_t m_second;
+    /// location of the intersection
+    osmium::Location m_location;
+
+    SegmentIntersection(size_t first, size_t second, osmium::Location location) :
+        m_first(first),
+        m_second(second),
+        m_location(location) {};
+
+    struct LessThanComparator {
+        bool operator()(const SegmentIntersection& lhs, const SegmentIntersection& rhs) const {
+            return (lhs.m_first == rhs.m_first && lhs.m_second < rhs.m_second) || lhs.m_first < rhs.m_first;
+        }
+    };
+};
 
 class IntermediateSimplifier : public AbstractWaySimplifier {
     ErrorsMap& m_error_segments;
-    std::vector<BoundarySegment>& m_all_segments;
+    BoundarySegmentStore& m_all_segments;
     KeepNodesMap& m_kept_nodes;
     osmium::util::VerboseOutput& m_vout;
 
+    /// position in m_error_segments where the next lookup starts
+    size_t m_error_segments_position = 0;
+
+    /// segments of the current way which should not be simplified, reused for every way
+    std::vector<NoSimplifySegment*> m_no_simplify;
+
+    /// number of threads used to look for intersections
+    unsigned int m_threads;
+
+    /**
+     * Spatial index of the segments which have been checked already. It is built after the first check
+     * and rebuilt if many segments have been added since.
+     */
+    SegmentIndex m_index;
+
+    /// Segments before this position in m_all_segments have been checked for intersections already.
+    size_t m_checked_count = 0;
+
+    /// Segments before this position in m_all_segments are part of m_index (if they were active).
+    size_t m_indexed_count = 0;
+
+    /**
+     * \brief Part of the segments which is checked by a single thread.
+     *
+     * A strip contains the segments whose western end lies in the strip and the segments of the
+     * strips further west which reach into this strip.
+     */
+    struct SweepStrip {
+        /// indexes of the segments, sorted by x
+        std::vector<size_t> m_order;
+        /// position of the first segment in m_order which belongs to this strip
+        size_t m_first_owned = 0;
+    };
+
+    /**
+     * Get the orientation of the triangle a, b, c.
+     *
+     * \returns 1 if c is left of the line from a to b, -1 if it is right of it and 0 if all three
+     * locations are on the same line
+     */
+    static int orientation(const osmium::Location& a, const osmium::Location& b, const osmium::Location& c);
+
     void improve_simplification(const osmium::Way& way);
 
     osmium::Location get_nearest_node_to_intersection(const osmium::Location& intersection,
             BoundarySegment& segment1, BoundarySegment& segment2);
 
-    std::vector<NoSimplifySegment*> sort_no_simplify_segments(osmium::object_id_type way_id);
+    /**
+     * Collect the segments of a way which have been reported since the last call into m_no_simplify.
+     *
+     * The segments are ordered by their offsets and duplicates are skipped.
+     */
+    void collect_no_simplify_segments(osmium::object_id_type way_id);
 
-    bool outside_x_range(const osmium::UndirectedSegment& s1, const osmium::UndirectedSegment& s2);
+    /**
+     * Check two segments with overlapping bounding boxes and remember them if they intersect.
+     */
+    void check_pair(const size_t index1, const size_t index2, std::vector<SegmentIntersection>& intersections) const;
 
-    bool y_range_overlap(const osmium::UndirectedSegment& s1, const osmium::UndirectedSegment& s2);
+    /**
+     * Add a segment to the list of segments which must not be simplified that much.
+     *
+     * Every segment is reported only once.
+     */
+    void report_segment(const size_t index, const osmium::Location& intersection);
+
+    /**
+     * Report all segments involved in the given intersections.
+     *
+     * \returns true if any intersection has been found
+     */
+    bool report_intersections(const std::vector<SegmentIntersection>& intersections);
+
+    /**
+     * Find all intersections among the given segments using a single sweep line.
+     *
+     * \param order indexes of the segments to check, sorted by x
+     * \param intersections vector to add the intersections to
+     */
+    void find_intersections(const std::vector<size_t>& order, std::vector<SegmentIntersection>& intersections) const;
+
+    /**
+     * Find all intersections among the given segments using multiple threads.
+     *
+     * The segments are split into strips from west to east. Segments reaching into the strips
+     * east of them are copied into these strips. Every strip is checked by its own sweep line.
+     * A pair of segments is only reported by the strip containing the western end of the segment
+     * which enters the sweep line later. Therefore no intersection is reported twice.
+     *
+     * \param order indexes of the segments to check, sorted by x
+     * \param intersections vector to add the intersections to
+     */
+    void find_intersections_parallel(const std::vector<size_t>& order, std::vector<SegmentIntersection>& intersections) const;
+
+    /**
+     * Check all segments added since the last check.
+     *
+     * New segments are compared with the spatial index and with all other segments which are not part of the
+     * spatial index yet. Pairs of segments which have been checked before are not checked again.
+     *
+     * \param intersections vector to add the intersections to
+     */
+    void find_new_intersections(std::vector<SegmentIntersection>& intersections) const;
+
+    /**
+     * Get the indexes of all active segments in the given range.
+     */
+    std::vector<size_t> active_segments(const size_t begin, const size_t end) const;
+
+    /**
+     * Rebuild the spatial index from all active segments.
+     */
+    void rebuild_index();
 public:
-    IntermediateSimplifier(double epsilon, ErrorsMap& error_segments, std::vector<BoundarySegment>& all_segments,
-            KeepNodesMap& keep_nodes, osmium::util::VerboseOutput& vout);
+    IntermediateSimplifier(double epsilon, ErrorsMap& error_segments, BoundarySegmentStore& all_segments,
+            KeepNodesMap& keep_nodes, osmium::util::VerboseOutput& vout, const unsigned int threads = 1);
 
     void way(const osmium::Way& way);
 
     /**
      * Check if still intersections exist.
+     *
+     * The first call checks all segments. Later calls only check the segments which have been added
+     * by the last iteration because all other pairs of segments have been checked before.
+     *
+     * The segments which should not be simplified and the nodes to be kept are sorted afterwards.
      */
     bool recheck_intersections();
 
-    osmium::Location intersection(const osmium::Segment& s1, const osmium::Segment&s2);
+    /**
+     * Get the location where two segments intersect.
+     *
+     * The test uses exact integer arithmetics on the coordinates of the locations. Floating point
+     * arithmetics is only used to calculate the location if the segments cross each other.
+     * Segments sharing a location do not intersect.
+     *
+     * \returns invalid location if the segments do not intersect, a location on both segments otherwise
+     */
+    osmium::Location intersection(const osmium::Segment& s1, const osmium::Segment&s2) const;
 };
 
 
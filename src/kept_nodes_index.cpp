@@ -0,0 +1,88 @@
+/*
+ * kept_nodes_index.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include <algorithm>
+#include <utility>
+#include "kept_nodes_index.hpp"
+
+KeptNodesIndex::KeptNodesIndex() :
+    m_way_ids(),
+    m_first_offsets(1, 0),
+    m_offsets() {}
+
+void KeptNodesIndex::add_way(const osmium::object_id_type way_id, const std::vector<bool>& kept) {
+    m_way_ids.push_back(way_id);
+    for (size_t i = 0; i < kept.size(); ++i) {
+        if (kept[i]) {
+            m_offsets.push_back(static_cast<uint32_t>(i));
+        }
+    }
+    m_first_offsets.push_back(m_offsets.size());
+}
+
+void KeptNodesIndex::append(const KeptNodesIndex& other) {
+    const size_t offset = m_offsets.size();
+    m_way_ids.insert(m_way_ids.end(), other.m_way_ids.begin(), other.m_way_ids.end());
+    m_offsets.insert(m_offsets.end(), other.m_offsets.begin(), other.m_offsets.end());
+    for (size_t i = 1; i < other.m_first_offsets.size(); ++i) {
+        m_first_offsets.push_back(offset + other.m_first_offsets[i]);
+    }
+}
+
+void KeptNodesIndex::sort() {
+    if (std::is_sorted(m_way_ids.cbegin(), m_way_ids.cend())) {
+        return;
+    }
+    std::vector<size_t> order (m_way_ids.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this](const size_t lhs, const size_t rhs) {
+        return m_way_ids[lhs] < m_way_ids[rhs];
+    });
+    std::vector<osmium::object_id_type> way_ids;
+    way_ids.reserve(m_way_ids.size());
+    std::vector<size_t> first_offsets;
+    first_offsets.reserve(m_first_offsets.size());
+    first_offsets.push_back(0);
+    std::vector<uint32_t> offsets;
+    offsets.reserve(m_offsets.size());
+    for (const size_t i : order) {
+        way_ids.push_back(m_way_ids[i]);
+        offsets.insert(offsets.end(), m_offsets.cbegin() + m_first_offsets[i],
+                m_offsets.cbegin() + m_first_offsets[i + 1]);
+        first_offsets.push_back(offsets.size());
+    }
+    m_way_ids = std::move(way_ids);
+    m_first_offsets = std::move(first_offsets);
+    m_offsets = std::move(offsets);
+}
+
+bool KeptNodesIndex::find(const osmium::object_id_type way_id, const uint32_t*& begin, const uint32_t*& end,
+        size_t& position) const {
+    size_t pos = position;
+    if (pos >= m_way_ids.size() || m_way_ids[pos] != way_id) {
+        std::vector<osmium::object_id_type>::const_iterator it = std::lower_bound(m_way_ids.cbegin(),
+                m_way_ids.cend(), way_id);
+        if (it == m_way_ids.cend() || *it != way_id) {
+            return false;
+        }
+        pos = static_cast<size_t>(it - m_way_ids.cbegin());
+    }
+    begin = m_offsets.data() + m_first_offsets[pos];
+    end = m_offsets.data() + m_first_offsets[pos + 1];
+    position = pos + 1;
+    return true;
+}
+
+size_t KeptNodesIndex::size() const {
+    return m_way_ids.size();
+}
+
+size_t KeptNodesIndex::used_memory() const {
+    return m_way_ids.capacity() * sizeof(osmium::object_id_type) + m_first_offsets.capacity() * sizeof(size_t)
+            + m_offsets.capacity() * sizeof(uint32_t);
+}
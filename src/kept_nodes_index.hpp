@@ -0,0 +1,78 @@
+/*
+ * kept_nodes_index.hpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#ifndef SRC_KEPT_NODES_INDEX_HPP_
+#define SRC_KEPT_NODES_INDEX_HPP_
+
+#include <cstdint>
+#include <vector>
+#include <osmium/osm/types.hpp>
+
+/**
+ * \brief Offsets of the nodes of each way which have been kept by the simplification.
+ *
+ * The offsets of all ways are stored in a single vector (compressed sparse row format). The
+ * caller keeps the position of the next expected way. If the way at this position is a different
+ * one, a binary search is used. Therefore sort() has to be called after the last way has been
+ * added if the ways have not been added ordered by ID.
+ */
+class KeptNodesIndex {
+    /// IDs of the ways
+    std::vector<osmium::object_id_type> m_way_ids;
+
+    /// position of the first offset of each way in m_offsets, plus the end of the last way
+    std::vector<size_t> m_first_offsets;
+
+    /// offsets of the kept nodes from the start of their way
+    std::vector<uint32_t> m_offsets;
+
+public:
+    KeptNodesIndex();
+
+    /**
+     * Add a way.
+     *
+     * \param way_id ID of the way
+     * \param kept flag for every node of the way, set if the node is kept
+     */
+    void add_way(const osmium::object_id_type way_id, const std::vector<bool>& kept);
+
+    /**
+     * Add all ways of another index to the end of this index.
+     */
+    void append(const KeptNodesIndex& other);
+
+    /**
+     * Sort the ways by their ID. This is cheap if they are sorted already.
+     */
+    void sort();
+
+    /**
+     * Look up the kept nodes of a way.
+     *
+     * \param way_id ID of the way
+     * \param begin will be set to the first offset of the way
+     * \param end will be set to the end of the offsets of the way
+     * \param position position where the way is expected (0 for the first lookup), will be set
+     * to the position after the way if it is found
+     *
+     * \returns false if the way is unknown
+     */
+    bool find(const osmium::object_id_type way_id, const uint32_t*& begin, const uint32_t*& end,
+            size_t& position) const;
+
+    /**
+     * Get number of ways.
+     */
+    size_t size() const;
+
+    /**
+     * Get the number of bytes used by the index.
+     */
+    size_t used_memory() const;
+};
+
+#endif /* SRC_KEPT_NODES_INDEX_HPP_ */
@@ -0,0 +1,57 @@
+/*
+ * merge_sorted_runs.hpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#ifndef SRC_MERGE_SORTED_RUNS_HPP_
+#define SRC_MERGE_SORTED_RUNS_HPP_
+
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * \brief Merge sorted ranges and call a function for every element of the merged sequence.
+ *
+ * Elements whose key is equal to the key of the previous element are skipped. Because the key
+ * is copied, the ranges may be given by input iterators which invalidate the element they pointed
+ * to when advanced (e.g. osmium::io::InputIterator).
+ *
+ * \param runs begin and end of every sorted range
+ * \param less order of the elements, every range has to be sorted by it
+ * \param key function returning the key of an element used to detect duplicates
+ * \param function function to be called with every element which is not a duplicate
+ */
+template <typename TIterator, typename TLess, typename TKey, typename TFunction>
+void merge_sorted_runs(const std::vector<std::pair<TIterator, TIterator>>& runs, TLess less, TKey key,
+        TFunction&& function) {
+    using run_type = std::pair<TIterator, TIterator>;
+    // std::priority_queue returns the largest element first.
+    auto greater = [&less](const run_type& lhs, const run_type& rhs) {
+        return less(*rhs.first, *lhs.first);
+    };
+    std::priority_queue<run_type, std::vector<run_type>, decltype(greater)> queue {greater};
+    for (const run_type& run : runs) {
+        if (run.first != run.second) {
+            queue.push(run);
+        }
+    }
+    bool first = true;
+    typename std::decay<decltype(key(*runs.front().first))>::type last_key {};
+    while (!queue.empty()) {
+        run_type run = queue.top();
+        queue.pop();
+        if (first || !(key(*run.first) == last_key)) {
+            last_key = key(*run.first);
+            first = false;
+            function(*run.first);
+        }
+        if (++run.first != run.second) {
+            queue.push(std::move(run));
+        }
+    }
+}
+
+#endif /* SRC_MERGE_SORTED_RUNS_HPP_ */
@@ -9,6 +9,7 @@
 #define SRC_NO_SIMPLIFY_SEGMENT_HPP_
 
 #include "boundary_segment.hpp"
+#include "way_table.hpp"
 
 /**
  * segment which should not be simplified to prevent intersections
@@ -24,7 +25,7 @@ struct NoSimplifySegment {
         m_end_offset(end),
         m_intersection(intersection) {};
 
-    NoSimplifySegment(BoundarySegment& segment, osmium::Location intersection) :
+    NoSimplifySegment(const BoundarySegment& segment, osmium::Location intersection) :
         m_start_offset(segment.get_start_offset()),
         m_end_offset(segment.get_end_offset()),
         m_intersection(intersection) {};
@@ -61,7 +62,10 @@ inline bool operator>=(const NoSimplifySegment& lhs, const NoSimplifySegment& rh
     return ! (lhs < rhs);
 }
 
-using ErrorsMap = std::unordered_multimap<osmium::object_id_type, NoSimplifySegment>;
-using KeepNodesMap = std::unordered_multimap<osmium::object_id_type, size_t>;
+/// segments of each way which should not be simplified
+using ErrorsMap = WayTable<NoSimplifySegment>;
+
+/// offsets of the nodes of each way which have to be kept to prevent intersections
+using KeepNodesMap = WayTable<size_t>;
 
 #endif /* SRC_NO_SIMPLIFY_SEGMENT_HPP_ */
@@ -0,0 +1,78 @@
+/*
+ * node_id_set.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include <algorithm>
+#include "node_id_set.hpp"
+
+constexpr size_t NodeIdSet::CHUNK_BITS;
+constexpr size_t NodeIdSet::WORDS_PER_CHUNK;
+
+NodeIdSet::~NodeIdSet() {
+    for (size_t i = 0; i < m_chunk_count; ++i) {
+        delete[] m_chunks[i].load();
+    }
+}
+
+void NodeIdSet::reserve(const osmium::object_id_type max_id) {
+    if (max_id < 0) {
+        return;
+    }
+    const size_t chunk_count = static_cast<size_t>(max_id) / CHUNK_BITS + 1;
+    if (chunk_count <= m_chunk_count) {
+        return;
+    }
+    // Grow by at least 50 % to avoid copying the pointers too often if the set is reserved way by way.
+    const size_t new_count = std::max(chunk_count, m_chunk_count + m_chunk_count / 2);
+    std::unique_ptr<chunk_pointer[]> chunks {new chunk_pointer[new_count]};
+    for (size_t i = 0; i < new_count; ++i) {
+        chunks[i].store(i < m_chunk_count ? m_chunks[i].load() : nullptr);
+    }
+    m_chunks = std::move(chunks);
+    m_chunk_count = new_count;
+}
+
+NodeIdSet::word_type* NodeIdSet::chunk(const size_t index) {
+    word_type* result = m_chunks[index].load(std::memory_order_acquire);
+    if (result) {
+        return result;
+    }
+    // Value-initialisation sets all bits to zero.
+    word_type* new_chunk = new word_type[WORDS_PER_CHUNK]();
+    if (m_chunks[index].compare_exchange_strong(result, new_chunk, std::memory_order_acq_rel)) {
+        ++m_allocated_chunks;
+        return new_chunk;
+    }
+    // Another thread has been faster.
+    delete[] new_chunk;
+    return result;
+}
+
+bool NodeIdSet::insert(const osmium::object_id_type id) {
+    if (id < 0) {
+        return true;
+    }
+    const size_t bit = static_cast<size_t>(id);
+    word_type* words = chunk(bit / CHUNK_BITS);
+    const uint64_t mask = static_cast<uint64_t>(1) << (bit % 64);
+    const uint64_t previous = words[(bit % CHUNK_BITS) / 64].fetch_or(mask, std::memory_order_relaxed);
+    return (previous & mask) == 0;
+}
+
+bool NodeIdSet::contains(const osmium::object_id_type id) const {
+    if (id < 0 || static_cast<size_t>(id) / CHUNK_BITS >= m_chunk_count) {
+        return false;
+    }
+    const size_t bit = static_cast<size_t>(id);
+    const word_type* words = m_chunks[bit / CHUNK_BITS].load(std::memory_order_acquire);
+    if (!words) {
+        return false;
+    }
+    return (words[(bit % CHUNK_BITS) / 64].load(std::memory_order_relaxed) & (static_cast<uint64_t>(1) << (bit % 64))) != 0;
+}
+
+size_t NodeIdSet::used_memory() const {
+    return m_chunk_count * sizeof(chunk_pointer) + m_allocated_chunks.load() * WORDS_PER_CHUNK * sizeof(word_type);
+}
@@ -0,0 +1,78 @@
+/*
+ * node_id_set.hpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#ifndef SRC_NODE_ID_SET_HPP_
+#define SRC_NODE_ID_SET_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <osmium/osm/types.hpp>
+
+/**
+ * \brief Bitmap of node IDs which can be filled by multiple threads at the same time.
+ *
+ * The bitmap is split into chunks of CHUNK_BITS IDs. A chunk is only allocated when the first ID
+ * of its range is inserted. Therefore the memory usage depends on the number of chunks containing
+ * nodes, not on the largest ID. Negative IDs are not stored.
+ *
+ * The range of IDs has to be reserved before inserting them. Reserving is not thread-safe,
+ * inserting is.
+ */
+class NodeIdSet {
+public:
+    static constexpr size_t CHUNK_BITS = 1 << 16;
+
+private:
+    static constexpr size_t WORDS_PER_CHUNK = CHUNK_BITS / 64;
+
+    using word_type = std::atomic<uint64_t>;
+    using chunk_pointer = std::atomic<word_type*>;
+
+    /// one pointer per chunk, null if the chunk has not been allocated yet
+    std::unique_ptr<chunk_pointer[]> m_chunks;
+
+    size_t m_chunk_count = 0;
+
+    std::atomic<size_t> m_allocated_chunks {0};
+
+    /**
+     * Get a chunk, allocate it if necessary.
+     */
+    word_type* chunk(const size_t index);
+
+public:
+    NodeIdSet() = default;
+
+    ~NodeIdSet();
+
+    NodeIdSet(const NodeIdSet&) = delete;
+    NodeIdSet& operator=(const NodeIdSet&) = delete;
+
+    /**
+     * Make IDs up to max_id insertable. Must not be called while other threads insert IDs.
+     */
+    void reserve(const osmium::object_id_type max_id);
+
+    /**
+     * Add an ID to the set.
+     *
+     * \returns true if the ID was not in the set before or if the ID is negative
+     */
+    bool insert(const osmium::object_id_type id);
+
+    /**
+     * Check if an ID is in the set.
+     */
+    bool contains(const osmium::object_id_type id) const;
+
+    /**
+     * Get the number of bytes used by the set.
+     */
+    size_t used_memory() const;
+};
+
+#endif /* SRC_NODE_ID_SET_HPP_ */
@@ -9,7 +9,9 @@
 #include <osmium/io/reader.hpp>
 #include <osmium/io/any_input.hpp>
 #include <osmium/util/progress_bar.hpp>
+#include "admin_level_pbf_rewriter.hpp"
 #include "admin_rel_handlers.hpp"
+#include "relation_reader.hpp"
 #include "way_admin_level_index.hpp"
 
 void print_help(char* argv[]) {
@@ -18,9 +20,15 @@ void print_help(char* argv[]) {
             "ways get the admin_level of the relation with the lowest \n" \
             "Usage: " << argv[0] << " [ARGS] INPUT_FILE OUTPUT_FILE\n" \
             "Arguments:\n" \
+            "  -L FILE, --level-index=FILE\n" \
+            "                           Load the admin level index from FILE if it has been\n" \
+            "                           built from the same input file with the same maximum\n" \
+            "                           level. Otherwise, build it and save it to FILE.\n" \
             "  -M NUM, --max-level=NUM  Process levels 2 to N only (default 11). Ways with\n" \
             "                           higher levels will not get modified if they are not\n" \
             "                           used by a relation of interest.\n" \
+            "  -P, --no-passthrough     Decode and encode all blocks of PBF files. By default,\n" \
+            "                           blocks without affected ways are copied unchanged.\n" \
             "  -v, --verbose            Enable verbose mode (show progress bar)\n";
     exit(1);
 }
@@ -28,16 +36,20 @@ void print_help(char* argv[]) {
 int main(int argc, char* argv[]) {
     static struct option long_options[] = {
         {"help", no_argument, 0, 'h'},
+        {"level-index", required_argument, 0, 'L'},
         {"max-level", required_argument, 0, 'M'},
+        {"no-passthrough", no_argument, 0, 'P'},
         {"verbose", no_argument, 0, 'v'},
         {0, 0, 0, 0}
     };
     int max_level = 11;
     bool verbose = false;
+    bool passthrough = true;
+    std::string level_index_filename;
     std::string input_filename;
     std::string output_filename;
     while (true) {
-        int c = getopt_long(argc, argv, "hM:v", long_options, 0);
+        int c = getopt_long(argc, argv, "hL:M:Pv", long_options, 0);
         if (c == -1) {
             break;
         }
@@ -47,6 +59,9 @@ int main(int argc, char* argv[]) {
         case 'h':
             print_help(argv);
             break;
+        case 'L':
+            level_index_filename = optarg;
+            break;
         case 'M':
             max_level = static_cast<int>(strtol(optarg, ptr, 10));
             if (ptr || max_level < 2 || max_level > 11) {
@@ -54,6 +69,9 @@ int main(int argc, char* argv[]) {
                 exit(1);
             }
             break;
+        case 'P':
+            passthrough = false;
+            break;
         case 'v':
             verbose = true;
             break;
@@ -68,21 +86,52 @@ int main(int argc, char* argv[]) {
     }
     input_filename =  argv[optind];
     output_filename = argv[optind + 1];
+    if (!level_index_filename.empty() && input_filename == "-") {
+        std::cerr << "ERROR: Option --level-index cannot be used if the input is read from standard input.\n";
+        exit(1);
+    }
 
     WayAdminLevelIndex way_level_idx;
     osmium::io::File input_file(input_filename);
-    std::cerr << "Reading relations\n";
-    {
-        AdminRelHandler1 handler1 {way_level_idx, max_level};
-        osmium::io::Reader reader1{input_file, osmium::osm_entity_bits::relation};
-        osmium::ProgressBar progress_bar{reader1.file_size(), osmium::util::isatty(2) && verbose};
-        while (osmium::memory::Buffer buffer = reader1.read()) {
-            progress_bar.update(reader1.offset());
-            osmium::apply(buffer, handler1);
+    WayAdminLevelIndex::Source index_source {0, 0, static_cast<WayAdminLevelIndex::AdminLevel>(max_level)};
+    bool index_loaded = false;
+    if (!level_index_filename.empty()) {
+        try {
+            index_source = WayAdminLevelIndex::source_of(input_filename, index_source.m_max_level);
+            index_loaded = way_level_idx.load(level_index_filename, index_source);
+        } catch (std::exception& e) {
+            std::cerr << "ERROR: " << e.what() << '\n';
+            exit(1);
+        }
+    }
+    if (index_loaded) {
+        std::cerr << "Using admin level index " << level_index_filename << '\n';
+    } else {
+        std::cerr << "Reading relations\n";
+        {
+            AdminRelHandler1 handler1 {way_level_idx, max_level};
+            RelationReader reader1{input_file};
+            osmium::ProgressBar progress_bar{reader1.file_size(), osmium::util::isatty(2) && verbose};
+            while (osmium::memory::Buffer buffer = reader1.read()) {
+                progress_bar.update(reader1.offset());
+                osmium::apply(buffer, handler1);
+            }
+            reader1.close();
+        }
+        way_level_idx.prepare_for_query();
+        if (!level_index_filename.empty()) {
+            try {
+                way_level_idx.save(level_index_filename, index_source);
+            } catch (std::exception& e) {
+                std::cerr << "ERROR: " << e.what() << '\n';
+                exit(1);
+            }
         }
-        reader1.close();
     }
-    way_level_idx.prepare_for_query();
+    if (verbose) {
+        std::cerr << "Admin level index uses " << way_level_idx.used_memory() / 1024 << " KiB ("
+                << (way_level_idx.layout() == WayAdminLevelIndex::Layout::dense ? "dense" : "delta-coded") << ").\n";
+    }
     osmium::io::Header header;
     header.set("generator", "osm_admin_level_rels2ways");
     header.set("copyright", "OpenStreetMap and contributors");
@@ -90,8 +139,27 @@ int main(int argc, char* argv[]) {
     header.set("license", "http://opendatacommons.org/licenses/odbl/1-0/");
     osmium::io::File output_file {output_filename};
     std::cerr << "Writing to output file\n";
-    AdminRelHandler2 handler2 {way_level_idx, output_file, header, max_level};
-    {
+    bool written = false;
+    if (passthrough && input_file.format() == osmium::io::file_format::pbf
+            && output_file.format() == osmium::io::file_format::pbf
+            && input_filename != "-" && output_filename != "-") {
+        try {
+            AdminLevelPbfRewriter rewriter {way_level_idx, static_cast<WayAdminLevelIndex::AdminLevel>(max_level),
+                input_filename, output_filename, "osm_admin_level_rels2ways"};
+            osmium::ProgressBar progress_bar{rewriter.file_size(), osmium::util::isatty(2) && verbose};
+            rewriter.run(progress_bar);
+            progress_bar.done();
+            written = true;
+            if (verbose) {
+                std::cerr << rewriter.copied_blob_count() << " blocks copied, " << rewriter.rewritten_blob_count()
+                        << " blocks rewritten.\n";
+            }
+        } catch (std::runtime_error& e) {
+            std::cerr << "Cannot copy blocks of the input file (" << e.what() << "), decoding all blocks.\n";
+        }
+    }
+    if (!written) {
+        AdminRelHandler2 handler2 {way_level_idx, output_file, header, static_cast<WayAdminLevelIndex::AdminLevel>(max_level)};
         osmium::io::Reader reader2(input_file);
         osmium::ProgressBar progress_bar{reader2.file_size(), osmium::util::isatty(2) && verbose};
         while (osmium::memory::Buffer buffer = reader2.read()) {
@@ -100,8 +168,8 @@ int main(int argc, char* argv[]) {
         }
         reader2.close();
         progress_bar.done();
-        if (verbose) {
-            std::cerr << way_level_idx.size() << " ways are used by admin boundary relations.\n";
-        }
+    }
+    if (verbose) {
+        std::cerr << way_level_idx.size() << " ways are used by admin boundary relations.\n";
     }
 }
@@ -14,6 +14,7 @@
 #include <osmium/util/progress_bar.hpp>
 #include "admin_rel_handlers.hpp"
 #include "admin_shp_handler.hpp"
+#include "relation_reader.hpp"
 #include "way_admin_level_index.hpp"
 
 using index_type = osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>;
@@ -27,6 +28,10 @@ void print_help(char* argv[]) {
             "Arguments:\n" \
             "  -i ARG, --index=ARG      Location index type (default: sparse_mmap_array, alternative:\n" \
 			"                           dense_mmap_array)\n" \
+            "  -L FILE, --level-index=FILE\n" \
+            "                           Load the admin level index from FILE if it has been\n" \
+            "                           built from the same input file with the same maximum\n" \
+            "                           level. Otherwise, build it and save it to FILE.\n" \
             "  -M NUM, --max-level=NUM  Process levels 2 to N only (default 11).\n" \
             "  -v, --verbose            Enable verbose mode (show progress bar)\n";
     exit(1);
@@ -36,6 +41,7 @@ int main(int argc, char* argv[]) {
     static struct option long_options[] = {
         {"help", no_argument, 0, 'h'},
         {"index", required_argument, 0, 'i'},
+        {"level-index", required_argument, 0, 'L'},
         {"max-level", required_argument, 0, 'M'},
         {"verbose", no_argument, 0, 'v'},
         {0, 0, 0, 0}
@@ -43,10 +49,11 @@ int main(int argc, char* argv[]) {
     int max_level = 11;
     bool verbose = false;
     std::string index = "sparse_mmap_array";
+    std::string level_index_filename;
     std::string input_filename;
     std::string output_filename;
     while (true) {
-        int c = getopt_long(argc, argv, "hi:M:v", long_options, 0);
+        int c = getopt_long(argc, argv, "hi:L:M:v", long_options, 0);
         if (c == -1) {
             break;
         }
@@ -64,6 +71,9 @@ int main(int argc, char* argv[]) {
         		exit(1);
         	}
             break;
+        case 'L':
+            level_index_filename = optarg;
+            break;
         case 'M':
             max_level = static_cast<int>(strtol(optarg, ptr, 10));
             if (ptr || max_level < 2 || max_level > 11) {
@@ -85,6 +95,10 @@ int main(int argc, char* argv[]) {
     }
     input_filename =  argv[optind];
     output_filename = argv[optind + 1];
+    if (!level_index_filename.empty() && input_filename == "-") {
+        std::cerr << "ERROR: Option --level-index cannot be used if the input is read from standard input.\n";
+        exit(1);
+    }
 
     const auto& map_factory = osmium::index::MapFactory<osmium::unsigned_object_id_type, osmium::Location>::instance();
     auto location_index = map_factory.create_map(index);
@@ -93,18 +107,45 @@ int main(int argc, char* argv[]) {
 
     WayAdminLevelIndex way_level_idx;
     osmium::io::File input_file(input_filename);
-    std::cerr << "Reading relations\n";
-    {
-        AdminRelHandler1 handler1 {way_level_idx, max_level};
-        osmium::io::Reader reader1{input_file, osmium::osm_entity_bits::relation};
-        osmium::ProgressBar progress_bar{reader1.file_size(), osmium::util::isatty(2) && verbose};
-        while (osmium::memory::Buffer buffer = reader1.read()) {
-            progress_bar.update(reader1.offset());
-            osmium::apply(buffer, handler1);
+    WayAdminLevelIndex::Source index_source {0, 0, static_cast<WayAdminLevelIndex::AdminLevel>(max_level)};
+    bool index_loaded = false;
+    if (!level_index_filename.empty()) {
+        try {
+            index_source = WayAdminLevelIndex::source_of(input_filename, index_source.m_max_level);
+            index_loaded = way_level_idx.load(level_index_filename, index_source);
+        } catch (std::exception& e) {
+            std::cerr << "ERROR: " << e.what() << '\n';
+            exit(1);
         }
-        reader1.close();
     }
-    way_level_idx.prepare_for_query();
+    if (index_loaded) {
+        std::cerr << "Using admin level index " << level_index_filename << '\n';
+    } else {
+        std::cerr << "Reading relations\n";
+        {
+            AdminRelHandler1 handler1 {way_level_idx, max_level};
+            RelationReader reader1{input_file};
+            osmium::ProgressBar progress_bar{reader1.file_size(), osmium::util::isatty(2) && verbose};
+            while (osmium::memory::Buffer buffer = reader1.read()) {
+                progress_bar.update(reader1.offset());
+                osmium::apply(buffer, handler1);
+            }
+            reader1.close();
+        }
+        way_level_idx.prepare_for_query();
+        if (!level_index_filename.empty()) {
+            try {
+                way_level_idx.save(level_index_filename, index_source);
+            } catch (std::exception& e) {
+                std::cerr << "ERROR: " << e.what() << '\n';
+                exit(1);
+            }
+        }
+    }
+    if (verbose) {
+        std::cerr << "Admin level index uses " << way_level_idx.used_memory() / 1024 << " KiB ("
+                << (way_level_idx.layout() == WayAdminLevelIndex::Layout::dense ? "dense" : "delta-coded") << ").\n";
+    }
     std::cerr << "Writing to output file\n";
     AdminSHPHandler handler2 {way_level_idx, output_filename, max_level};
     {
@@ -15,6 +15,7 @@
 #include <osmium/index/map/dense_mmap_array.hpp>
 #include <osmium/handler/node_locations_for_ways.hpp>
 #include "boundary_filter_collector.hpp"
+#include "relation_reader.hpp"
 
 using index_type = osmium::index::map::Map<osmium::unsigned_object_id_type, osmium::Location>;
 using location_handler_type = osmium::handler::NodeLocationsForWays<index_type>;
@@ -160,7 +161,7 @@ int main(int argc, char* argv[]) {
 
     BoundaryFilterCollector collector(output_filename, check_functions, changeset, lastchange, version, add_nodes, add_relations);
     osmium::io::File input_file(input_filename);
-    osmium::io::Reader reader1{input_file, osmium::osm_entity_bits::relation};
+    RelationReader reader1{input_file};
     collector.read_relations(reader1);
     reader1.close();
     osmium::io::Reader reader2(input_file);
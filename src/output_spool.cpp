@@ -0,0 +1,125 @@
+/*
+ * output_spool.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <unistd.h>
+#include <osmium/io/any_input.hpp>
+#include <osmium/io/any_output.hpp>
+#include <osmium/io/input_iterator.hpp>
+#include <osmium/io/output_iterator.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/object_pointer_collection.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+#include <osmium/osm/object_comparisons.hpp>
+#include <osmium/visitor.hpp>
+#include "merge_sorted_runs.hpp"
+#include "output_spool.hpp"
+
+/// size of the in-memory buffers when they are created, they grow automatically
+constexpr size_t INITIAL_BUFFER_SIZE = 1024 * 1024;
+
+/**
+ * Open a temporary file for writing. The file is not compressed because it is read only once.
+ */
+static std::unique_ptr<osmium::io::Writer> open_temporary_file(const std::string& filename) {
+    osmium::io::File file {filename, "pbf"};
+    file.set("pbf_compression", "none");
+    file.set("locations_on_ways", true);
+    return std::unique_ptr<osmium::io::Writer>{new osmium::io::Writer{file, osmium::io::Header{},
+        osmium::io::overwrite::allow}};
+}
+
+OutputSpool::OutputSpool(const std::string& directory, const size_t memory_budget) :
+    m_directory(directory),
+    m_memory_budget(memory_budget),
+    m_objects(INITIAL_BUFFER_SIZE, osmium::memory::Buffer::auto_grow::yes) {}
+
+OutputSpool::~OutputSpool() {
+    for (const std::string& filename : m_run_filenames) {
+        std::remove(filename.c_str());
+    }
+}
+
+std::string OutputSpool::create_temporary_file() const {
+    std::string name = m_directory + "/admin_polygon_simplify_XXXXXX";
+    std::vector<char> name_template (name.begin(), name.end());
+    name_template.push_back('\0');
+    int fd = mkstemp(name_template.data());
+    if (fd == -1) {
+        throw std::system_error{errno, std::system_category(), "Failed to create temporary file in " + m_directory};
+    }
+    close(fd);
+    return std::string{name_template.data()};
+}
+
+void OutputSpool::add(const osmium::memory::Buffer& buffer) {
+    for (auto it = buffer.cbegin<osmium::OSMObject>(); it != buffer.cend<osmium::OSMObject>(); ++it) {
+        if (it->type() == osmium::item_type::node || it->type() == osmium::item_type::way) {
+            m_objects.add_item(*it);
+            m_objects.commit();
+        }
+    }
+    if (m_objects.committed() > m_memory_budget) {
+        spill();
+    }
+}
+
+void OutputSpool::spill() {
+    m_run_filenames.push_back(create_temporary_file());
+    std::unique_ptr<osmium::io::Writer> run_writer = open_temporary_file(m_run_filenames.back());
+    write_objects_in_memory(*run_writer);
+    run_writer->close();
+}
+
+void OutputSpool::write_objects_in_memory(osmium::io::Writer& writer) {
+    osmium::ObjectPointerCollection objects;
+    osmium::apply(m_objects, objects);
+    objects.sort(osmium::object_order_type_id_reverse_version());
+    // std::copy (i.e. copy without comparing the objects) does not work. Nodes with tags beyond the
+    // bounding box will not be written to the output file.
+    std::unique_copy(objects.cbegin(), objects.cend(), osmium::io::make_output_iterator(writer),
+            osmium::object_equal_type_id());
+    m_objects = osmium::memory::Buffer{INITIAL_BUFFER_SIZE, osmium::memory::Buffer::auto_grow::yes};
+}
+
+void OutputSpool::write(osmium::io::Writer& writer) {
+    if (m_run_filenames.empty()) {
+        write_objects_in_memory(writer);
+        return;
+    }
+    // Write the remaining objects to a run as well because runs and the buffer cannot be merged at once.
+    if (m_objects.committed() > 0) {
+        spill();
+    }
+    using iterator = osmium::io::InputIterator<osmium::io::Reader, osmium::OSMObject>;
+    std::vector<std::unique_ptr<osmium::io::Reader>> readers;
+    std::vector<std::pair<iterator, iterator>> runs;
+    for (const std::string& filename : m_run_filenames) {
+        readers.emplace_back(new osmium::io::Reader{osmium::io::File{filename, "pbf"},
+            osmium::osm_entity_bits::node | osmium::osm_entity_bits::way});
+        runs.emplace_back(iterator{*readers.back()}, iterator{});
+    }
+    merge_sorted_runs(runs, osmium::object_order_type_id_reverse_version(),
+            [](const osmium::OSMObject& object) {
+        return std::make_pair(object.type(), object.id());
+    }, [&writer](const osmium::OSMObject& object) {
+        writer(object);
+    });
+    for (std::unique_ptr<osmium::io::Reader>& reader : readers) {
+        reader->close();
+    }
+}
+
+size_t OutputSpool::run_count() const {
+    return m_run_filenames.size();
+}
@@ -0,0 +1,85 @@
+/*
+ * output_spool.hpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#ifndef SRC_OUTPUT_SPOOL_HPP_
+#define SRC_OUTPUT_SPOOL_HPP_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <osmium/io/writer.hpp>
+#include <osmium/memory/buffer.hpp>
+
+/**
+ * \brief Collect the simplified ways and their nodes with bounded memory usage and write them
+ * sorted to the output file.
+ *
+ * Nodes and ways may be added in any order, nodes may be added multiple times. If the objects
+ * kept in memory exceed the memory budget, they are sorted and written to a temporary file (a
+ * sorted run). When writing the output, the runs are merged and duplicated nodes are dropped.
+ */
+class OutputSpool {
+    /// directory of the temporary files
+    std::string m_directory;
+
+    /// maximum size of the buffer kept in memory (bytes)
+    size_t m_memory_budget;
+
+    /// nodes and ways which have not been written to a run yet
+    osmium::memory::Buffer m_objects;
+
+    /// names of the temporary files containing sorted nodes and ways
+    std::vector<std::string> m_run_filenames;
+
+    /**
+     * Create an empty temporary file and return its name.
+     */
+    std::string create_temporary_file() const;
+
+    /**
+     * Write the objects kept in memory to a new run.
+     */
+    void spill();
+
+    /**
+     * Sort the objects kept in memory and write them to the writer without duplicates.
+     */
+    void write_objects_in_memory(osmium::io::Writer& writer);
+
+public:
+    /**
+     * \param directory directory for the temporary files
+     * \param memory_budget maximum number of bytes used by the nodes and ways kept in memory
+     */
+    OutputSpool(const std::string& directory, const size_t memory_budget);
+
+    /**
+     * Delete the temporary files.
+     */
+    ~OutputSpool();
+
+    OutputSpool(const OutputSpool&) = delete;
+    OutputSpool& operator=(const OutputSpool&) = delete;
+
+    /**
+     * Add all nodes and ways of a buffer.
+     */
+    void add(const osmium::memory::Buffer& buffer);
+
+    /**
+     * Write all nodes sorted by ID without duplicates followed by all ways sorted by ID.
+     *
+     * This method must be called only once.
+     */
+    void write(osmium::io::Writer& writer);
+
+    /**
+     * Get the number of sorted runs written to temporary files.
+     */
+    size_t run_count() const;
+};
+
+#endif /* SRC_OUTPUT_SPOOL_HPP_ */
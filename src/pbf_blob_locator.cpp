@@ -0,0 +1,218 @@
+/*
+ * pbf_blob_locator.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include <stdexcept>
+#include <protozero/pbf_reader.hpp>
+#include <zlib.h>
+#include "pbf_blob_locator.hpp"
+
+/// maximum size of a blob header allowed by the PBF specification
+constexpr uint32_t MAX_BLOB_HEADER_SIZE = 64 * 1024;
+
+/// maximum size of a blob (compressed or uncompressed) allowed by the PBF specification
+constexpr uint32_t MAX_BLOB_SIZE = 32 * 1024 * 1024;
+
+/**
+ * Decode the size of a blob header (4 bytes, network byte order).
+ */
+static uint32_t decode_header_size(const std::string& bytes) {
+    return (static_cast<uint32_t>(static_cast<unsigned char>(bytes[0])) << 24)
+            | (static_cast<uint32_t>(static_cast<unsigned char>(bytes[1])) << 16)
+            | (static_cast<uint32_t>(static_cast<unsigned char>(bytes[2])) << 8)
+            | static_cast<uint32_t>(static_cast<unsigned char>(bytes[3]));
+}
+
+PbfBlobLocator::PbfBlobLocator(const std::string& filename) :
+    m_stream(filename, std::ios::binary),
+    m_header_blob{0, 0} {
+    if (!m_stream) {
+        throw std::runtime_error{"Failed to open " + filename};
+    }
+    m_stream.seekg(0, std::ios::end);
+    m_file_size = static_cast<uint64_t>(m_stream.tellg());
+    uint64_t offset = 0;
+    bool header_found = false;
+    while (offset < m_file_size) {
+        const uint32_t header_size = decode_header_size(read(offset, 4));
+        if (header_size > MAX_BLOB_HEADER_SIZE) {
+            throw std::runtime_error{"Invalid blob header size in " + filename};
+        }
+        const std::string header = read(offset + 4, header_size);
+        std::string type;
+        int32_t data_size = -1;
+        protozero::pbf_reader message {header.data(), header.size()};
+        while (message.next()) {
+            switch (message.tag()) {
+            case 1: // type
+                type = message.get_string();
+                break;
+            case 3: // datasize
+                data_size = message.get_int32();
+                break;
+            default:
+                message.skip();
+            }
+        }
+        if (data_size < 0 || static_cast<uint32_t>(data_size) > MAX_BLOB_SIZE) {
+            throw std::runtime_error{"Invalid blob size in " + filename};
+        }
+        const Blob blob {offset, 4 + header_size + static_cast<uint64_t>(data_size)};
+        if (offset + blob.m_size > m_file_size) {
+            throw std::runtime_error{"Truncated blob in " + filename};
+        }
+        if (type == "OSMHeader" && !header_found) {
+            m_header_blob = blob;
+            header_found = true;
+        } else if (type == "OSMData" && header_found) {
+            m_data_blobs.push_back(blob);
+        } else {
+            throw std::runtime_error{"Unexpected blob of type " + type + " in " + filename};
+        }
+        offset += blob.m_size;
+    }
+    if (!header_found) {
+        throw std::runtime_error{"No header blob found in " + filename};
+    }
+
+    // look for the Sort.Type_then_ID feature in the required and optional features
+    const std::string block = header_block();
+    protozero::pbf_reader message {block.data(), block.size()};
+    while (message.next()) {
+        if (message.tag() == 4 || message.tag() == 5) {
+            if (message.get_string() == "Sort.Type_then_ID") {
+                m_sorted = true;
+            }
+        } else {
+            message.skip();
+        }
+    }
+}
+
+std::string PbfBlobLocator::read(const uint64_t offset, const uint64_t size) {
+    if (offset + size > m_file_size) {
+        throw std::runtime_error{"Truncated PBF file"};
+    }
+    std::string result (size, '\0');
+    m_stream.seekg(static_cast<std::streamoff>(offset));
+    m_stream.read(&result[0], static_cast<std::streamsize>(size));
+    if (!m_stream) {
+        throw std::runtime_error{"Failed to read PBF file"};
+    }
+    return result;
+}
+
+std::string PbfBlobLocator::decompress(const Blob& blob) {
+    const uint64_t header_size = decode_header_size(read(blob.m_offset, 4));
+    const std::string data = read(blob.m_offset + 4 + header_size, blob.m_size - 4 - header_size);
+    protozero::pbf_reader message {data.data(), data.size()};
+    int32_t raw_size = 0;
+    protozero::data_view zlib_data;
+    while (message.next()) {
+        switch (message.tag()) {
+        case 1: { // raw
+            const protozero::data_view raw = message.get_view();
+            return std::string{raw.data(), raw.size()};
+        }
+        case 2: // raw_size
+            raw_size = message.get_int32();
+            break;
+        case 3: // zlib_data
+            zlib_data = message.get_view();
+            break;
+        case 4: // lzma_data
+        case 5: // OBSOLETE_bzip2_data
+        case 6: // lz4_data
+        case 7: // zstd_data
+            throw std::runtime_error{"Unsupported compression of PBF blob"};
+        default:
+            message.skip();
+        }
+    }
+    if (raw_size < 0 || static_cast<uint32_t>(raw_size) > MAX_BLOB_SIZE) {
+        throw std::runtime_error{"Invalid raw size of PBF blob"};
+    }
+    std::string result (static_cast<size_t>(raw_size), '\0');
+    uLongf result_size = static_cast<uLongf>(raw_size);
+    if (::uncompress(reinterpret_cast<Bytef*>(&result[0]), &result_size,
+            reinterpret_cast<const Bytef*>(zlib_data.data()), static_cast<uLong>(zlib_data.size())) != Z_OK
+            || result_size != static_cast<uLongf>(raw_size)) {
+        throw std::runtime_error{"Failed to decompress PBF blob"};
+    }
+    return result;
+}
+
+osmium::item_type PbfBlobLocator::first_item_type(const Blob& blob) {
+    const std::string block = decompress(blob);
+    protozero::pbf_reader message {block.data(), block.size()};
+    while (message.next(2)) { // primitivegroup
+        protozero::pbf_reader group = message.get_message();
+        if (group.next()) {
+            switch (group.tag()) {
+            case 1: // nodes
+            case 2: // dense
+                return osmium::item_type::node;
+            case 3:
+                return osmium::item_type::way;
+            case 4:
+                return osmium::item_type::relation;
+            case 5:
+                return osmium::item_type::changeset;
+            default:
+                break;
+            }
+        }
+    }
+    return osmium::item_type::undefined;
+}
+
+bool PbfBlobLocator::sorted() const {
+    return m_sorted;
+}
+
+const PbfBlobLocator::Blob& PbfBlobLocator::header_blob() const {
+    return m_header_blob;
+}
+
+const std::vector<PbfBlobLocator::Blob>& PbfBlobLocator::data_blobs() const {
+    return m_data_blobs;
+}
+
+uint64_t PbfBlobLocator::file_size() const {
+    return m_file_size;
+}
+
+size_t PbfBlobLocator::first_blob_with(const osmium::item_type type) {
+    // binary search for the first blob starting with an object of this type or a later type
+    size_t begin = 0;
+    size_t end = m_data_blobs.size();
+    while (begin < end) {
+        const size_t middle = begin + (end - begin) / 2;
+        const osmium::item_type middle_type = first_item_type(m_data_blobs[middle]);
+        // Empty blocks are treated like blocks of earlier types.
+        if (middle_type == osmium::item_type::undefined || middle_type < type) {
+            begin = middle + 1;
+        } else {
+            end = middle;
+        }
+    }
+    return begin > 0 ? begin - 1 : 0;
+}
+
+std::string PbfBlobLocator::header_block() {
+    return decompress(m_header_blob);
+}
+
+std::string PbfBlobLocator::raw_blobs(const size_t begin, const size_t end) {
+    if (begin >= end) {
+        return std::string{};
+    }
+    const uint64_t offset = m_data_blobs[begin].m_offset;
+    return read(offset, m_data_blobs[end - 1].m_offset + m_data_blobs[end - 1].m_size - offset);
+}
+
+std::string PbfBlobLocator::file_image(const size_t begin, const size_t end) {
+    return read(m_header_blob.m_offset, m_header_blob.m_size) + raw_blobs(begin, end);
+}
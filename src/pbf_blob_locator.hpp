@@ -0,0 +1,120 @@
+/*
+ * pbf_blob_locator.hpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#ifndef SRC_PBF_BLOB_LOCATOR_HPP_
+#define SRC_PBF_BLOB_LOCATOR_HPP_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <osmium/osm/item_type.hpp>
+
+/**
+ * \brief Positions of the blobs of a PBF file.
+ *
+ * The constructor reads the blob headers of the whole file without reading or decompressing the
+ * blobs themselves. In a file sorted by type and ID, the first blob containing objects of a given
+ * type can be found with a binary search which decompresses only a few blobs to look at the type
+ * of their first object.
+ *
+ * Only uncompressed and zlib compressed blobs can be decompressed. All methods throw
+ * std::runtime_error if the file is not a valid PBF file or uses an unsupported compression.
+ */
+class PbfBlobLocator {
+public:
+    /**
+     * \brief Position of a blob in the file.
+     */
+    struct Blob {
+        /// offset of the length of the blob header
+        uint64_t m_offset;
+
+        /// size of the length of the blob header, the blob header and the blob
+        uint64_t m_size;
+    };
+
+private:
+    std::ifstream m_stream;
+
+    /// the blob of type OSMHeader
+    Blob m_header_blob;
+
+    /// all blobs of type OSMData
+    std::vector<Blob> m_data_blobs;
+
+    /// size of the file in bytes
+    uint64_t m_file_size = 0;
+
+    /// true if the file is flagged as sorted by type and ID
+    bool m_sorted = false;
+
+    /**
+     * Read a range of the file.
+     */
+    std::string read(const uint64_t offset, const uint64_t size);
+
+    /**
+     * Get the type of the first object of a data blob.
+     *
+     * \returns osmium::item_type::undefined if the blob is empty
+     */
+    osmium::item_type first_item_type(const Blob& blob);
+
+public:
+    explicit PbfBlobLocator(const std::string& filename);
+
+    /**
+     * Has the file been flagged as sorted by type and ID (header feature Sort.Type_then_ID)?
+     */
+    bool sorted() const;
+
+    const Blob& header_blob() const;
+
+    const std::vector<Blob>& data_blobs() const;
+
+    uint64_t file_size() const;
+
+    /**
+     * Get the position of the first data blob which might contain objects of the given type.
+     *
+     * The file must be sorted by type and ID. The blob before the first blob which starts with an
+     * object of the given type is included because it might contain objects of different types.
+     *
+     * \returns index in data_blobs()
+     */
+    size_t first_blob_with(const osmium::item_type type);
+
+    /**
+     * Read a blob and return its decompressed content.
+     */
+    std::string decompress(const Blob& blob);
+
+    /**
+     * Get the decompressed content of the header blob (the HeaderBlock message).
+     */
+    std::string header_block();
+
+    /**
+     * Get the raw bytes of a range of data blobs.
+     *
+     * \param begin index of the first data blob
+     * \param end index after the last data blob
+     */
+    std::string raw_blobs(const size_t begin, const size_t end);
+
+    /**
+     * Get the raw bytes of the header blob followed by the raw bytes of a range of data blobs.
+     *
+     * The result is a valid PBF file.
+     *
+     * \param begin index of the first data blob
+     * \param end index after the last data blob
+     */
+    std::string file_image(const size_t begin, const size_t end);
+};
+
+#endif /* SRC_PBF_BLOB_LOCATOR_HPP_ */
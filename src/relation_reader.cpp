@@ -0,0 +1,103 @@
+/*
+ * relation_reader.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include <stdexcept>
+#include <osmium/io/pbf_input.hpp>
+#include "relation_reader.hpp"
+
+/// number of bytes of the input file passed to a reader at once
+constexpr uint64_t CHUNK_SIZE = 64 * 1024 * 1024;
+
+RelationReader::RelationReader(const osmium::io::File& file) {
+    if (file.format() == osmium::io::file_format::pbf && !file.filename().empty() && file.filename() != "-") {
+        try {
+            m_locator.reset(new PbfBlobLocator{file.filename()});
+            if (m_locator->sorted()) {
+                m_next_blob = m_locator->first_blob_with(osmium::item_type::relation);
+            } else {
+                m_locator.reset();
+            }
+        } catch (std::runtime_error&) {
+            // Fall back to reading the whole file. Errors in the file are reported by the reader.
+            m_locator.reset();
+        }
+    }
+    if (!m_locator) {
+        m_reader.reset(new osmium::io::Reader{file, osmium::osm_entity_bits::relation});
+    }
+}
+
+bool RelationReader::partial() const {
+    return static_cast<bool>(m_locator);
+}
+
+bool RelationReader::open_next_chunk() {
+    if (m_reader) {
+        m_reader->close();
+        m_reader.reset();
+    }
+    const std::vector<PbfBlobLocator::Blob>& blobs = m_locator->data_blobs();
+    if (m_next_blob >= blobs.size()) {
+        m_chunk.clear();
+        m_chunk_offset = m_locator->file_size();
+        return false;
+    }
+    const size_t begin = m_next_blob;
+    uint64_t size = 0;
+    do {
+        size += blobs[m_next_blob].m_size;
+        ++m_next_blob;
+    } while (m_next_blob < blobs.size() && size + blobs[m_next_blob].m_size <= CHUNK_SIZE);
+    m_chunk = m_locator->file_image(begin, m_next_blob);
+    m_chunk_offset = blobs[begin].m_offset;
+    m_reader.reset(new osmium::io::Reader{osmium::io::File{m_chunk.data(), m_chunk.size(), "pbf"},
+        osmium::osm_entity_bits::relation});
+    return true;
+}
+
+osmium::memory::Buffer RelationReader::read() {
+    if (!m_locator) {
+        return m_reader->read();
+    }
+    while (m_reader || open_next_chunk()) {
+        osmium::memory::Buffer buffer = m_reader->read();
+        if (buffer) {
+            return buffer;
+        }
+        m_reader->close();
+        m_reader.reset();
+    }
+    return osmium::memory::Buffer{};
+}
+
+void RelationReader::close() {
+    if (m_reader) {
+        m_reader->close();
+    }
+    if (m_locator) {
+        m_reader.reset();
+        m_next_blob = m_locator->data_blobs().size();
+    }
+}
+
+size_t RelationReader::file_size() const {
+    if (m_locator) {
+        return static_cast<size_t>(m_locator->file_size());
+    }
+    return m_reader->file_size();
+}
+
+size_t RelationReader::offset() const {
+    if (!m_locator) {
+        return m_reader->offset();
+    }
+    if (!m_reader) {
+        return static_cast<size_t>(m_chunk_offset);
+    }
+    const uint64_t header_size = m_locator->header_blob().m_size;
+    const uint64_t chunk_offset = m_reader->offset();
+    return static_cast<size_t>(m_chunk_offset + (chunk_offset > header_size ? chunk_offset - header_size : 0));
+}
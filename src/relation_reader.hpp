@@ -0,0 +1,71 @@
+/*
+ * relation_reader.hpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#ifndef SRC_RELATION_READER_HPP_
+#define SRC_RELATION_READER_HPP_
+
+#include <memory>
+#include <string>
+#include <osmium/io/file.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/memory/buffer.hpp>
+#include "pbf_blob_locator.hpp"
+
+/**
+ * \brief Read all relations of a file.
+ *
+ * If the input file is a PBF file sorted by type and ID, only the blobs containing relations are
+ * read and decompressed. They are passed to an osmium::io::Reader in chunks of a few megabytes.
+ * Other files are read with an osmium::io::Reader restricted to relations.
+ *
+ * The interface is a subset of the interface of osmium::io::Reader.
+ */
+class RelationReader {
+    std::unique_ptr<PbfBlobLocator> m_locator;
+
+    /// reader of the whole file or of the current chunk
+    std::unique_ptr<osmium::io::Reader> m_reader;
+
+    /// data of the current chunk, has to outlive m_reader
+    std::string m_chunk;
+
+    /// index of the first data blob of the next chunk
+    size_t m_next_blob = 0;
+
+    /// offset of the current chunk in the file
+    uint64_t m_chunk_offset = 0;
+
+    /**
+     * Open a reader for the next chunk of blobs.
+     *
+     * \returns false if there are no blobs left
+     */
+    bool open_next_chunk();
+
+public:
+    explicit RelationReader(const osmium::io::File& file);
+
+    /**
+     * Was the file sorted and is only the relation section of it read?
+     */
+    bool partial() const;
+
+    /**
+     * Read the next buffer. An invalid buffer is returned at the end of the file.
+     */
+    osmium::memory::Buffer read();
+
+    void close();
+
+    size_t file_size() const;
+
+    /**
+     * Get the approximate position in the input file.
+     */
+    size_t offset() const;
+};
+
+#endif /* SRC_RELATION_READER_HPP_ */
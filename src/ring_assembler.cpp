@@ -0,0 +1,90 @@
+/*
+ * ring_assembler.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include "ring_assembler.hpp"
+
+size_t RingAssembler::find(size_t ring) {
+    while (m_rings[ring].m_parent != ring) {
+        // path halving keeps the chains of merged rings short
+        m_rings[ring].m_parent = m_rings[m_rings[ring].m_parent].m_parent;
+        ring = m_rings[ring].m_parent;
+    }
+    return ring;
+}
+
+size_t RingAssembler::take_open_end(const osmium::object_id_type node_id) {
+    auto it = m_open_ends.find(node_id);
+    if (it == m_open_ends.end()) {
+        return m_rings.size();
+    }
+    const size_t ring = find(it->second);
+    m_open_ends.erase(it);
+    return ring;
+}
+
+void RingAssembler::add_to_ring(Ring& ring, const osmium::object_id_type way_id) {
+    if (ring.m_size < 2) {
+        ring.m_ways[ring.m_size] = way_id;
+    }
+    ++ring.m_size;
+}
+
+void RingAssembler::merge(const size_t target, const size_t source) {
+    Ring& target_ring = m_rings[target];
+    const Ring& source_ring = m_rings[source];
+    for (size_t w = 0; w < source_ring.m_size && target_ring.m_size + w < 2; ++w) {
+        target_ring.m_ways[target_ring.m_size + w] = source_ring.m_ways[w];
+    }
+    target_ring.m_size += source_ring.m_size;
+    m_rings[source].m_parent = target;
+}
+
+void RingAssembler::clear(const size_t way_count) {
+    m_rings.clear();
+    m_open_ends.clear();
+    m_open_ends.reserve(way_count * 2);
+}
+
+void RingAssembler::add_way(const osmium::object_id_type way_id, const osmium::object_id_type front,
+        const osmium::object_id_type back) {
+    const size_t none = m_rings.size();
+    if (front == back) {
+        // A closed way is a ring of its own.
+        m_rings.push_back(Ring{1, {way_id, 0}, true, none});
+        return;
+    }
+    const size_t front_ring = take_open_end(front);
+    const size_t back_ring = take_open_end(back);
+    if (front_ring == none && back_ring == none) {
+        m_rings.push_back(Ring{1, {way_id, 0}, false, none});
+        m_open_ends.emplace(front, none);
+        m_open_ends.emplace(back, none);
+    } else if (back_ring == none) {
+        add_to_ring(m_rings[front_ring], way_id);
+        m_open_ends.emplace(back, front_ring);
+    } else if (front_ring == none) {
+        add_to_ring(m_rings[back_ring], way_id);
+        m_open_ends.emplace(front, back_ring);
+    } else if (front_ring == back_ring) {
+        add_to_ring(m_rings[front_ring], way_id);
+        m_rings[front_ring].m_closed = true;
+    } else {
+        // The way connects two rings. Their other open ends still refer to the old rings and
+        // are resolved by find().
+        add_to_ring(m_rings[front_ring], way_id);
+        merge(front_ring, back_ring);
+    }
+}
+
+size_t RingAssembler::closed_ring_count() const {
+    size_t count = 0;
+    for (size_t i = 0; i < m_rings.size(); ++i) {
+        if (m_rings[i].m_parent == i && m_rings[i].m_closed) {
+            ++count;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,104 @@
+/*
+ * ring_assembler.hpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#ifndef SRC_RING_ASSEMBLER_HPP_
+#define SRC_RING_ASSEMBLER_HPP_
+
+#include <unordered_map>
+#include <vector>
+#include <osmium/osm/types.hpp>
+
+/**
+ * \brief Assemble the member ways of a relation to rings using their first and last nodes.
+ *
+ * The open ends of all rings are kept in a hash map from node ID to ring. A new way is attached
+ * to the rings ending at its first and last node. If these are two different rings, they are
+ * merged. Merged rings are tracked with a union-find structure.
+ *
+ * Only the number of ways and the IDs of the first two ways of every ring are stored because
+ * the caller is only interested in small rings.
+ */
+class RingAssembler {
+    struct Ring {
+        /// number of member ways
+        size_t m_size;
+
+        /// IDs of the first two member ways
+        osmium::object_id_type m_ways[2];
+
+        bool m_closed;
+
+        /// index of the ring this ring has been merged into, its own index if it has not been merged
+        size_t m_parent;
+    };
+
+    std::vector<Ring> m_rings;
+
+    /// ring of every open end, indexed by the ID of the node at the end
+    std::unordered_map<osmium::object_id_type, size_t> m_open_ends;
+
+    /**
+     * Get the ring a ring has been merged into.
+     */
+    size_t find(size_t ring);
+
+    /**
+     * Get the ring ending at a node and remove the end from the open ends.
+     *
+     * \returns index of the ring or m_rings.size() if no ring ends at this node
+     */
+    size_t take_open_end(const osmium::object_id_type node_id);
+
+    /**
+     * Add a way to a ring.
+     */
+    void add_to_ring(Ring& ring, const osmium::object_id_type way_id);
+
+    /**
+     * Merge the second ring into the first one.
+     */
+    void merge(const size_t target, const size_t source);
+
+public:
+    /**
+     * Remove all rings.
+     *
+     * \param way_count expected number of ways of the next relation
+     */
+    void clear(const size_t way_count);
+
+    /**
+     * Add a way.
+     *
+     * \param way_id ID of the way
+     * \param front ID of the first node of the way
+     * \param back ID of the last node of the way
+     */
+    void add_way(const osmium::object_id_type way_id, const osmium::object_id_type front,
+            const osmium::object_id_type back);
+
+    /**
+     * Get the number of closed rings.
+     */
+    size_t closed_ring_count() const;
+
+    /**
+     * Call a function with the ID of every way which belongs to a closed ring of one or two ways.
+     */
+    template <typename TFunction>
+    void for_each_way_of_small_rings(TFunction&& function) const {
+        for (size_t i = 0; i < m_rings.size(); ++i) {
+            const Ring& ring = m_rings[i];
+            if (ring.m_parent == i && ring.m_closed && ring.m_size <= 2) {
+                for (size_t w = 0; w < ring.m_size; ++w) {
+                    function(ring.m_ways[w]);
+                }
+            }
+        }
+    }
+};
+
+#endif /* SRC_RING_ASSEMBLER_HPP_ */
@@ -0,0 +1,161 @@
+/*
+ * segment_index.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "segment_index.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define SEGMENT_INDEX_AVX2
+# include <immintrin.h>
+#endif
+
+constexpr size_t SegmentIndex::NODE_SIZE;
+
+SegmentIndex::BBox::BBox(const BoundarySegmentStore& segments, const size_t index) :
+    m_x_min(segments.x_min(index)),
+    m_y_min(segments.y_min(index)),
+    m_x_max(segments.x_max(index)),
+    m_y_max(segments.y_max(index)) {}
+
+void SegmentIndex::BBox::extend(const BBox& other) {
+    m_x_min = std::min(m_x_min, other.m_x_min);
+    m_y_min = std::min(m_y_min, other.m_y_min);
+    m_x_max = std::max(m_x_max, other.m_x_max);
+    m_y_max = std::max(m_y_max, other.m_y_max);
+}
+
+uint32_t SegmentIndex::overlap_mask_scalar(const BBox& box, const int32_t* x_min, const int32_t* y_min,
+        const int32_t* x_max, const int32_t* y_max) {
+    uint32_t mask = 0;
+    for (size_t i = 0; i < NODE_SIZE; ++i) {
+        const bool overlaps = x_min[i] <= box.m_x_max && box.m_x_min <= x_max[i]
+                && y_min[i] <= box.m_y_max && box.m_y_min <= y_max[i];
+        mask |= static_cast<uint32_t>(overlaps) << i;
+    }
+    return mask;
+}
+
+#ifdef SEGMENT_INDEX_AVX2
+/**
+ * AVX2 implementation of SegmentIndex::overlap_mask_scalar, comparing eight boxes at once.
+ */
+__attribute__((target("avx2")))
+static uint32_t overlap_mask_avx2(const SegmentIndex::BBox& box, const int32_t* x_min, const int32_t* y_min,
+        const int32_t* x_max, const int32_t* y_max) {
+    const __m256i box_x_min = _mm256_set1_epi32(box.m_x_min);
+    const __m256i box_y_min = _mm256_set1_epi32(box.m_y_min);
+    const __m256i box_x_max = _mm256_set1_epi32(box.m_x_max);
+    const __m256i box_y_max = _mm256_set1_epi32(box.m_y_max);
+    uint32_t mask = 0;
+    for (size_t i = 0; i < SegmentIndex::NODE_SIZE; i += 8) {
+        // AVX2 has no "less or equal" comparison of integers. We look for the boxes which do not overlap instead.
+        __m256i outside = _mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x_min + i)), box_x_max);
+        outside = _mm256_or_si256(outside,
+                _mm256_cmpgt_epi32(box_x_min, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x_max + i))));
+        outside = _mm256_or_si256(outside,
+                _mm256_cmpgt_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(y_min + i)), box_y_max));
+        outside = _mm256_or_si256(outside,
+                _mm256_cmpgt_epi32(box_y_min, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y_max + i))));
+        const uint32_t outside_mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(outside)));
+        mask |= (~outside_mask & 0xff) << i;
+    }
+    return mask;
+}
+#endif
+
+SegmentIndex::overlap_function_type SegmentIndex::best_overlap_function() {
+#ifdef SEGMENT_INDEX_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return overlap_mask_avx2;
+    }
+#endif
+    return overlap_mask_scalar;
+}
+
+SegmentIndex::SegmentIndex(overlap_function_type overlap_function) :
+    m_overlap_mask(overlap_function) {}
+
+void SegmentIndex::push_back(const BBox& box) {
+    m_x_min.push_back(box.m_x_min);
+    m_y_min.push_back(box.m_y_min);
+    m_x_max.push_back(box.m_x_max);
+    m_y_max.push_back(box.m_y_max);
+}
+
+void SegmentIndex::pad() {
+    // This box does not overlap any box with valid coordinates.
+    const BBox empty {std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::max(),
+        std::numeric_limits<int32_t>::min(), std::numeric_limits<int32_t>::min()};
+    while (m_x_min.size() % NODE_SIZE != 0) {
+        push_back(empty);
+    }
+}
+
+void SegmentIndex::build(const BoundarySegmentStore& segments, std::vector<size_t> indexes) {
+    m_x_min.clear();
+    m_y_min.clear();
+    m_x_max.clear();
+    m_y_max.clear();
+    m_level_bounds.clear();
+    m_items = std::move(indexes);
+    if (m_items.empty()) {
+        return;
+    }
+    // Sort-Tile-Recursive: sort by x, cut into vertical slices and sort each slice by y.
+    // Coordinates are summed up as 64 bit integers to get the centre of the bounding box without an overflow.
+    auto x_centre = [&segments](const size_t i) {
+        return static_cast<int64_t>(segments.x_min(i)) + segments.x_max(i);
+    };
+    auto y_centre = [&segments](const size_t i) {
+        return static_cast<int64_t>(segments.y_min(i)) + segments.y_max(i);
+    };
+    std::sort(m_items.begin(), m_items.end(), [&x_centre](const size_t a, const size_t b) {
+        return x_centre(a) < x_centre(b);
+    });
+    const size_t leaf_count = (m_items.size() + NODE_SIZE - 1) / NODE_SIZE;
+    const size_t slice_count = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(leaf_count))));
+    const size_t slice_size = slice_count * NODE_SIZE;
+    for (size_t begin = 0; begin < m_items.size(); begin += slice_size) {
+        const size_t end = std::min(begin + slice_size, m_items.size());
+        std::sort(m_items.begin() + begin, m_items.begin() + end, [&y_centre](const size_t a, const size_t b) {
+            return y_centre(a) < y_centre(b);
+        });
+    }
+
+    const size_t capacity = (leaf_count + leaf_count / (NODE_SIZE - 1) + 2) * NODE_SIZE;
+    m_x_min.reserve(capacity);
+    m_y_min.reserve(capacity);
+    m_x_max.reserve(capacity);
+    m_y_max.reserve(capacity);
+    for (const size_t i : m_items) {
+        push_back(BBox{segments, i});
+    }
+    size_t level_count = m_items.size();
+    pad();
+    m_level_bounds.push_back(0);
+    m_level_bounds.push_back(m_x_min.size());
+    // Build the upper levels until there is only a single root node.
+    while (level_count > 1 || m_level_bounds.size() == 2) {
+        const size_t child_begin = m_level_bounds[m_level_bounds.size() - 2];
+        const size_t child_end = child_begin + level_count;
+        for (size_t c = child_begin; c < child_end; c += NODE_SIZE) {
+            BBox box {m_x_min[c], m_y_min[c], m_x_max[c], m_y_max[c]};
+            for (size_t i = c + 1; i < std::min(c + NODE_SIZE, child_end); ++i) {
+                box.extend(BBox{m_x_min[i], m_y_min[i], m_x_max[i], m_y_max[i]});
+            }
+            push_back(box);
+        }
+        level_count = (level_count + NODE_SIZE - 1) / NODE_SIZE;
+        pad();
+        m_level_bounds.push_back(m_x_min.size());
+    }
+}
+
+size_t SegmentIndex::size() const {
+    return m_items.size();
+}
@@ -0,0 +1,141 @@
+/*
+ * segment_index.hpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#ifndef SRC_SEGMENT_INDEX_HPP_
+#define SRC_SEGMENT_INDEX_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "boundary_segment_store.hpp"
+
+/**
+ * \brief Static spatial index (packed R-tree) of the bounding boxes of segments.
+ *
+ * The index is built once from a set of segments and cannot be modified afterwards. The entries
+ * are sorted using the Sort-Tile-Recursive algorithm and packed into nodes of NODE_SIZE entries.
+ * All nodes are stored level by level, starting with the leaves. The children of a node are the
+ * NODE_SIZE consecutive entries of the level below.
+ *
+ * The bounding boxes are stored in four separate arrays of coordinates. Every level is padded
+ * with empty boxes to a multiple of NODE_SIZE. This way the children of a node can be compared
+ * with the query box in one go using SIMD instructions.
+ */
+class SegmentIndex {
+public:
+    struct BBox {
+        int32_t m_x_min;
+        int32_t m_y_min;
+        int32_t m_x_max;
+        int32_t m_y_max;
+
+        BBox(const int32_t x_min, const int32_t y_min, const int32_t x_max, const int32_t y_max) :
+            m_x_min(x_min),
+            m_y_min(y_min),
+            m_x_max(x_max),
+            m_y_max(y_max) {};
+
+        BBox(const BoundarySegmentStore& segments, const size_t index);
+
+        bool overlaps(const BBox& other) const {
+            return m_x_min <= other.m_x_max && other.m_x_min <= m_x_max
+                    && m_y_min <= other.m_y_max && other.m_y_min <= m_y_max;
+        }
+
+        void extend(const BBox& other);
+    };
+
+    static constexpr size_t NODE_SIZE = 16;
+
+    /**
+     * Function comparing NODE_SIZE bounding boxes with a single box.
+     *
+     * \returns bit mask of the boxes overlapping the box, bit i is set if box i overlaps
+     */
+    using overlap_function_type = uint32_t (*)(const BBox& box, const int32_t* x_min, const int32_t* y_min,
+            const int32_t* x_max, const int32_t* y_max);
+
+    static uint32_t overlap_mask_scalar(const BBox& box, const int32_t* x_min, const int32_t* y_min,
+            const int32_t* x_max, const int32_t* y_max);
+
+    /**
+     * Get the fastest implementation of the overlap test supported by this CPU.
+     */
+    static overlap_function_type best_overlap_function();
+
+private:
+    /// bounding boxes of all levels, leaves (i.e. the segments) first
+    std::vector<int32_t> m_x_min;
+    std::vector<int32_t> m_y_min;
+    std::vector<int32_t> m_x_max;
+    std::vector<int32_t> m_y_max;
+
+    /// indexes of the segments in the same order as the leaves
+    std::vector<size_t> m_items;
+
+    /// position of the first entry of each level, plus the end of the last level
+    std::vector<size_t> m_level_bounds;
+
+    overlap_function_type m_overlap_mask;
+
+    void push_back(const BBox& box);
+
+    /**
+     * Add empty boxes until the number of boxes is a multiple of NODE_SIZE.
+     */
+    void pad();
+
+public:
+    explicit SegmentIndex(overlap_function_type overlap_function = best_overlap_function());
+
+    /**
+     * Build the index.
+     *
+     * \param segments all segments
+     * \param indexes indexes of the segments to be added to the index
+     */
+    void build(const BoundarySegmentStore& segments, std::vector<size_t> indexes);
+
+    /**
+     * Get number of segments in the index.
+     */
+    size_t size() const;
+
+    /**
+     * Call the callback with the index of every segment whose bounding box overlaps the given box.
+     */
+    template <typename TCallback>
+    void query(const BBox& box, TCallback&& callback) const {
+        if (m_items.empty()) {
+            return;
+        }
+        // stack of (level, position in level) of nodes to visit
+        std::vector<std::pair<size_t, size_t>> stack;
+        stack.emplace_back(m_level_bounds.size() - 2, 0);
+        while (!stack.empty()) {
+            const size_t level = stack.back().first;
+            const size_t node = stack.back().second;
+            stack.pop_back();
+            const size_t child_level = level - 1;
+            const size_t first_child = m_level_bounds[child_level] + node * NODE_SIZE;
+            uint32_t mask = m_overlap_mask(box, m_x_min.data() + first_child, m_y_min.data() + first_child,
+                    m_x_max.data() + first_child, m_y_max.data() + first_child);
+            for (size_t c = node * NODE_SIZE; mask != 0; ++c, mask >>= 1) {
+                if ((mask & 1) == 0) {
+                    continue;
+                }
+                if (child_level == 0) {
+                    callback(m_items[c]);
+                } else {
+                    stack.emplace_back(child_level, c);
+                }
+            }
+        }
+    }
+};
+
+#endif /* SRC_SEGMENT_INDEX_HPP_ */
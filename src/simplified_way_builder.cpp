@@ -0,0 +1,112 @@
+/*
+ * simplified_way_builder.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include "simplified_way_builder.hpp"
+
+SimplifiedWayBuilder::SimplifiedWayBuilder(osmium::memory::Buffer& output_buffer, double epsilon,
+        const KeepNodesMap& keep_nodes, const KeptNodesIndex& kept_nodes_index,
+        const WayIdSet& treat_as_rings_way, NodeIdSet& written_nodes) :
+        AbstractWaySimplifier(epsilon),
+        m_output_buffer(output_buffer),
+        m_kept_nodes(keep_nodes),
+        m_kept_nodes_index(kept_nodes_index),
+        m_treat_as_rings_way(treat_as_rings_way),
+        m_written_nodes(written_nodes) { }
+
+void SimplifiedWayBuilder::add_tags(osmium::builder::Builder* builder, const osmium::TagList& tags) {
+    osmium::builder::TagListBuilder tl_builder(m_output_buffer, builder);
+    for (const osmium::Tag& t : tags) {
+        tl_builder.add_tag(t);
+    }
+}
+
+void SimplifiedWayBuilder::way(const osmium::Way& way) {
+    // write ways with less than four nodes directly to the output file
+    if (way.nodes().size() <= 3 || (way.nodes().size() == 4 && (way.nodes().front() == way.nodes().back()))) {
+        m_output_buffer.add_item(way);
+        m_output_buffer.commit();
+        for (const osmium::NodeRef& nd_ref : way.nodes()) {
+            add_node_to_buffer(&nd_ref);
+        }
+        m_output_buffer.commit();
+    } else  {
+        {
+            osmium::builder::WayBuilder way_builder(m_output_buffer);
+            osmium::Way& new_way = static_cast<osmium::Way&>(way_builder.object());
+            new_way.set_id(way.id());
+            new_way.set_changeset(way.changeset());
+            new_way.set_uid(way.uid());
+            new_way.set_version(way.version());
+            new_way.set_visible(way.visible());
+            new_way.set_timestamp(way.timestamp());
+            way_builder.set_user(way.user());
+            add_simplified_node_list(&way_builder, way.nodes(), way.id());
+            add_tags(&way_builder, way.tags());
+        }
+        m_output_buffer.commit();
+        // Write every node to the node buffer
+        for (size_t i = 0; i != m_kept.size(); ++i) {
+            if (m_kept[i]) {
+                add_node_to_buffer(&way.nodes()[i]);
+            }
+        }
+        m_output_buffer.commit();
+    }
+}
+
+void SimplifiedWayBuilder::add_kept_nodes_to_list(const osmium::object_id_type way_id) {
+    std::pair<KeepNodesMap::const_iterator, KeepNodesMap::const_iterator> it_range = m_kept_nodes.equal_range(way_id,
+            m_kept_nodes_map_position);
+    for (KeepNodesMap::const_iterator it = it_range.first; it != it_range.second; it++) {
+        m_kept.at(it->second) = true;
+    }
+}
+
+void SimplifiedWayBuilder::add_simplified_node_list(osmium::builder::Builder* builder,
+        const osmium::WayNodeList& node_list, osmium::object_id_type way_id) {
+    const uint32_t* kept_begin;
+    const uint32_t* kept_end;
+    if (m_kept_nodes_index.find(way_id, kept_begin, kept_end, m_kept_nodes_position)) {
+        // reuse the result of the simplification in pass 3
+        m_kept.assign(node_list.size(), false);
+        for (const uint32_t* it = kept_begin; it != kept_end; ++it) {
+            m_kept[*it] = true;
+        }
+        // add nodes which are preserved to prevent intersections
+        add_kept_nodes_to_list(way_id);
+    } else {
+        // We don't discard the first and last node
+        start_way(node_list);
+
+        // add nodes which are preserved to prevent intersections
+        add_kept_nodes_to_list(way_id);
+
+        // simplify the node list
+        simplify_way(node_list.front() == node_list.back() || m_treat_as_rings_way.contains(way_id, m_treat_as_rings_position));
+    }
+
+    // add node references to the to final object
+    osmium::builder::WayNodeListBuilder wnl_builder{m_output_buffer, builder};
+    for (size_t i = 0; i != m_kept.size(); ++i) {
+        if (m_kept[i]) {
+            wnl_builder.add_node_ref(node_list[i]);
+        }
+    }
+}
+
+void SimplifiedWayBuilder::add_node_to_buffer(const osmium::NodeRef* nd_ref) {
+    // Border nodes are shared by multiple ways. They are written only by the first way.
+    if (!m_written_nodes.insert(nd_ref->ref())) {
+        return;
+    }
+    osmium::builder::NodeBuilder builder(m_output_buffer);
+    osmium::Node& node = static_cast<osmium::Node&>(builder.object());
+    node.set_id(nd_ref->ref());
+    // otherwise the resulting OSM file does not contain the visible=true attribute and some programs behave strange
+    node.set_visible(true);
+    builder.set_user("");
+    node.set_location(nd_ref->location());
+}
@@ -0,0 +1,87 @@
+/*
+ * simplified_way_builder.hpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#ifndef SRC_SIMPLIFIED_WAY_BUILDER_HPP_
+#define SRC_SIMPLIFIED_WAY_BUILDER_HPP_
+
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/memory/buffer.hpp>
+#include "abstract_way_simplifier.hpp"
+#include "kept_nodes_index.hpp"
+#include "no_simplify_segment.hpp"
+#include "node_id_set.hpp"
+#include "way_id_set.hpp"
+
+/**
+ * \brief Build the simplified version of ways and their nodes in an output buffer.
+ *
+ * The builder only reads the shared data structures except of the set of written nodes which is
+ * thread-safe. Multiple builders writing into different buffers can therefore be used by multiple
+ * threads at the same time. The IDs of all nodes of a way have to be reserved in the set of written
+ * nodes before the way is passed to the builder.
+ */
+class SimplifiedWayBuilder : public AbstractWaySimplifier {
+    osmium::memory::Buffer& m_output_buffer;
+    const KeepNodesMap& m_kept_nodes;
+
+    /// nodes kept by the simplification in pass 3
+    const KeptNodesIndex& m_kept_nodes_index;
+
+    /// position in m_kept_nodes_index where the next lookup starts
+    size_t m_kept_nodes_position = 0;
+
+    /// position in m_kept_nodes where the next lookup starts
+    size_t m_kept_nodes_map_position = 0;
+
+    const WayIdSet& m_treat_as_rings_way;
+
+    /// position in m_treat_as_rings_way where the next lookup starts
+    size_t m_treat_as_rings_position = 0;
+
+    /// nodes which have been added to any output buffer, shared by all builders
+    NodeIdSet& m_written_nodes;
+
+    /**
+     * Mark the nodes which are preserved to prevent intersections as kept.
+     */
+    void add_kept_nodes_to_list(const osmium::object_id_type way_id);
+
+    void add_tags(osmium::builder::Builder* builder, const osmium::TagList& tags);
+
+    /**
+     * \brief add this node to the output buffer unless it has been added by any builder before
+     *
+     * Don't forget to commit after calling this method.
+     */
+    void add_node_to_buffer(const osmium::NodeRef* nd_ref);
+
+    /**
+     * Simplify a way but keeping essential nodes to prevent intersections.
+     *
+     * The nodes kept by the simplification in pass 3 are taken from the KeptNodesIndex. Douglas-Peucker
+     * is only run again if the way is missing in the index.
+     *
+     * \param builder Osmium object builder
+     * \param node_list node list of the way
+     * \param way_id ID of the way
+     *
+     * The nodes which have not been removed by the simplification are marked in #m_kept.
+     */
+    void add_simplified_node_list(osmium::builder::Builder* builder, const osmium::WayNodeList& node_list,
+            osmium::object_id_type way_id);
+
+public:
+    SimplifiedWayBuilder(osmium::memory::Buffer& output_buffer, double epsilon, const KeepNodesMap& keep_nodes,
+            const KeptNodesIndex& kept_nodes_index, const WayIdSet& treat_as_rings_way,
+            NodeIdSet& written_nodes);
+
+    /**
+     * Add the simplified way and all its remaining nodes to the output buffer.
+     */
+    void way(const osmium::Way& way);
+};
+
+#endif /* SRC_SIMPLIFIED_WAY_BUILDER_HPP_ */
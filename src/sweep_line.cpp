@@ -0,0 +1,136 @@
+/*
+ * sweep_line.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include "sweep_line.hpp"
+
+constexpr uint32_t SweepLine::NO_LIST;
+
+SweepLine::SweepLine(const BoundarySegmentStore& segments) :
+        m_active(),
+        m_exits(),
+        m_lower_ends(),
+        m_tree(),
+        m_lists(),
+        m_free_lists(),
+        m_is_active(),
+        m_hits(),
+        m_segments(segments) { }
+
+void SweepLine::prepare(const std::vector<size_t>& order) {
+    if (order.size() >= NO_LIST) {
+        throw std::length_error("Too many segments for the sweep line.");
+    }
+    m_lower_ends.clear();
+    for (const size_t index : order) {
+        m_lower_ends.push_back(m_segments.y_min(index));
+    }
+    std::sort(m_lower_ends.begin(), m_lower_ends.end());
+    m_lower_ends.erase(std::unique(m_lower_ends.begin(), m_lower_ends.end()), m_lower_ends.end());
+    m_tree.assign(2 * m_lower_ends.size(), NO_LIST);
+    m_lists.clear();
+    m_free_lists.clear();
+    m_is_active.assign(order.size(), false);
+}
+
+template <typename TFunction>
+void SweepLine::for_each_tree_node(const size_t index, TFunction&& function) {
+    const size_t leaf_count = m_lower_ends.size();
+    // leaves of the lower ends within the y range of the segment: [begin, end)
+    size_t begin = static_cast<size_t>(std::lower_bound(m_lower_ends.begin(), m_lower_ends.end(),
+            m_segments.y_min(index)) - m_lower_ends.begin()) + leaf_count;
+    size_t end = static_cast<size_t>(std::upper_bound(m_lower_ends.begin(), m_lower_ends.end(),
+            m_segments.y_max(index)) - m_lower_ends.begin()) + leaf_count;
+    // Walk up from both borders. A node is used if its parent reaches beyond the range.
+    for (; begin < end; begin /= 2, end /= 2) {
+        if (begin % 2 == 1) {
+            function(begin);
+            ++begin;
+        }
+        if (end % 2 == 1) {
+            --end;
+            function(end);
+        }
+    }
+}
+
+void SweepLine::add_to_node(const size_t node, const uint32_t pos) {
+    if (m_tree[node] == NO_LIST) {
+        if (m_free_lists.empty()) {
+            m_tree[node] = static_cast<uint32_t>(m_lists.size());
+            m_lists.emplace_back();
+        } else {
+            m_tree[node] = m_free_lists.back();
+            m_free_lists.pop_back();
+        }
+    }
+    m_lists[m_tree[node]].m_positions.push_back(pos);
+}
+
+void SweepLine::remove_from_node(const size_t node) {
+    NodeList& list = m_lists[m_tree[node]];
+    ++list.m_left_count;
+    if (2 * list.m_left_count > list.m_positions.size()) {
+        list.m_positions.erase(std::remove_if(list.m_positions.begin(), list.m_positions.end(),
+                [this](const uint32_t p) {
+            return !m_is_active[p];
+        }), list.m_positions.end());
+        list.m_left_count = 0;
+        if (list.m_positions.empty()) {
+            m_free_lists.push_back(m_tree[node]);
+            m_tree[node] = NO_LIST;
+        }
+    }
+}
+
+void SweepLine::enter(const std::vector<size_t>& order, const uint32_t pos) {
+    const size_t index = order[pos];
+    m_active.emplace(m_segments.y_min(index), pos);
+    m_exits.emplace(m_segments.x_max(index), pos);
+    m_is_active[pos] = true;
+    for_each_tree_node(index, [this, pos](const size_t node) {
+        add_to_node(node, pos);
+    });
+}
+
+void SweepLine::leave_before(const std::vector<size_t>& order, const int32_t x) {
+    while (!m_exits.empty() && m_exits.top().first < x) {
+        const uint32_t pos = m_exits.top().second;
+        const size_t index = order[pos];
+        m_active.erase(std::make_pair(m_segments.y_min(index), pos));
+        m_is_active[pos] = false;
+        for_each_tree_node(index, [this](const size_t node) {
+            remove_from_node(node);
+        });
+        m_exits.pop();
+    }
+}
+
+void SweepLine::query(const std::vector<size_t>& order, const size_t index) {
+    m_hits.clear();
+    const int32_t seg_y_min = m_segments.y_min(index);
+    const int32_t seg_y_max = m_segments.y_max(index);
+    // active segments whose lower end is within the y range
+    for (auto it = m_active.lower_bound(std::make_pair(seg_y_min, static_cast<uint32_t>(0)));
+            it != m_active.end() && it->first <= seg_y_max; ++it) {
+        m_hits.push_back(order[it->second]);
+    }
+    // Active segments containing y_min whose lower end is below it. The lower end of the queried
+    // segment is one of the leaves because it belongs to the run.
+    const size_t leaf = static_cast<size_t>(std::lower_bound(m_lower_ends.begin(), m_lower_ends.end(), seg_y_min)
+            - m_lower_ends.begin());
+    for (size_t node = leaf + m_lower_ends.size(); node > 0; node /= 2) {
+        if (m_tree[node] == NO_LIST) {
+            continue;
+        }
+        for (const uint32_t pos : m_lists[m_tree[node]].m_positions) {
+            if (m_is_active[pos] && m_segments.y_min(order[pos]) < seg_y_min) {
+                m_hits.push_back(order[pos]);
+            }
+        }
+    }
+}
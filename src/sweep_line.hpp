@@ -0,0 +1,152 @@
+/*
+ * sweep_line.hpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#ifndef SRC_SWEEP_LINE_HPP_
+#define SRC_SWEEP_LINE_HPP_
+
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <set>
+#include <utility>
+#include <vector>
+#include "boundary_segment_store.hpp"
+
+/**
+ * \brief Sweep line to find all pairs of segments whose bounding boxes overlap.
+ *
+ * The sweep line moves from west to east. A segment enters the active set when the sweep line
+ * reaches its western end and leaves it as soon as the sweep line has passed its eastern end.
+ *
+ * An active segment overlaps the y range [y_min, y_max] of an entering segment if its lower end
+ * lies in this range or if it contains y_min and its lower end lies below. The first case is
+ * answered by the active set ordered by the lower end of the segments, the second case by a
+ * segment tree over the lower ends of all segments of the run. Every node of the tree holds the
+ * active segments whose y range covers all lower ends of the node but not all of its parent, so
+ * the segments containing y_min are found on the path from the leaf of y_min to the root. Both
+ * lookups take O(log n + hits), tall segments do not slow down the queries of other segments.
+ *
+ * The tree is stored bottom-up without padding: the n leaves are at [n, 2n), the children of
+ * node i are at 2i and 2i+1. Most nodes never hold a segment. Therefore a node only stores the
+ * index of its list of segments and the lists are allocated when they are needed.
+ */
+class SweepLine {
+    /**
+     * \brief List of segments of a node of the segment tree.
+     */
+    struct NodeList {
+        /// positions of the segments in the order passed to run(), might contain segments which have left
+        std::vector<uint32_t> m_positions;
+
+        /// number of segments in m_positions which have left the active set
+        uint32_t m_left_count = 0;
+    };
+
+    /// value of m_tree for nodes without a list
+    static constexpr uint32_t NO_LIST = std::numeric_limits<uint32_t>::max();
+
+    /// active segments: lower end of the y range and position of the segment in the order
+    std::set<std::pair<int32_t, uint32_t>> m_active;
+
+    /// exit events: upper end of the x range and position of the segment in the order, smallest x first
+    std::priority_queue<std::pair<int32_t, uint32_t>, std::vector<std::pair<int32_t, uint32_t>>,
+            std::greater<std::pair<int32_t, uint32_t>>> m_exits;
+
+    /// lower ends of the y ranges of all segments of the run, sorted and without duplicates
+    std::vector<int32_t> m_lower_ends;
+
+    /// segment tree with 2 * m_lower_ends.size() nodes, index of the list of the node in m_lists or NO_LIST
+    std::vector<uint32_t> m_tree;
+
+    /// lists of the nodes of the tree
+    std::vector<NodeList> m_lists;
+
+    /// indexes of lists in m_lists which are empty and not used by any node
+    std::vector<uint32_t> m_free_lists;
+
+    /// indexed by the position in the order, true while the segment is active
+    std::vector<bool> m_is_active;
+
+    /// indexes of the active segments overlapping the segment of the last query
+    std::vector<size_t> m_hits;
+
+    const BoundarySegmentStore& m_segments;
+
+    /**
+     * Build the empty segment tree for the segments of a run.
+     *
+     * \throws std::length_error if there are too many segments for 32-bit positions
+     */
+    void prepare(const std::vector<size_t>& order);
+
+    /**
+     * Call a function for every node of the tree covering the y range of a segment exactly.
+     */
+    template <typename TFunction>
+    void for_each_tree_node(const size_t index, TFunction&& function);
+
+    /**
+     * Add a segment to the list of a node of the tree. Get a list for the node if it has none.
+     */
+    void add_to_node(const size_t node, const uint32_t pos);
+
+    /**
+     * Count a segment which has left as removed from the list of a node of the tree.
+     *
+     * Segments which have left are removed from a list as soon as they are the majority.
+     * Therefore skipping them does not increase the costs of a query by more than a constant
+     * factor. Lists becoming empty are given back to the pool.
+     */
+    void remove_from_node(const size_t node);
+
+    /**
+     * Add a segment to the active set.
+     */
+    void enter(const std::vector<size_t>& order, const uint32_t pos);
+
+    /**
+     * Remove all segments from the active set which end west of x.
+     */
+    void leave_before(const std::vector<size_t>& order, const int32_t x);
+
+    /**
+     * Fill m_hits with the active segments whose y range overlaps the y range of a segment.
+     */
+    void query(const std::vector<size_t>& order, const size_t index);
+
+public:
+    explicit SweepLine(const BoundarySegmentStore& segments);
+
+    /**
+     * Run the sweep line.
+     *
+     * \param order indexes of the segments to check, sorted by the x coordinate of their western end
+     * \param callback function to be called with the indexes of every pair of segments whose bounding
+     * boxes overlap. The first argument is the segment which entered the active set earlier.
+     * \param query_from Position in `order` of the first segment which should be compared with the
+     * active set. All segments before this position are only added to the active set. This is used
+     * if a segment is checked by multiple sweep lines and the pairs should be reported only once.
+     */
+    template <typename TCallback>
+    void run(const std::vector<size_t>& order, TCallback&& callback, const size_t query_from = 0) {
+        prepare(order);
+        for (uint32_t pos = 0; pos < order.size(); ++pos) {
+            const size_t index = order[pos];
+            leave_before(order, m_segments.x_min(index));
+            if (pos >= query_from) {
+                query(order, index);
+                for (const size_t other : m_hits) {
+                    callback(other, index);
+                }
+            }
+            enter(order, pos);
+        }
+        leave_before(order, std::numeric_limits<int32_t>::max());
+    }
+};
+
+#endif /* SRC_SWEEP_LINE_HPP_ */
@@ -19,15 +19,22 @@ Vector3D Vector3D::latlon_to_3d(const osmium::Location& point) {
     };
 }
 
-double Vector3D::vector_length() {
+Vector3D Vector3D::unit_vector(const osmium::Location& point) {
+    const double lon = osmium::geom::deg_to_rad(point.lon());
+    const double lat = osmium::geom::deg_to_rad(point.lat());
+    const double cos_lat = cos(lat);
+    return Vector3D {cos_lat * cos(lon), cos_lat * sin(lon), sin(lat)};
+}
+
+double Vector3D::vector_length() const {
     return sqrt(at(0) * at(0) + at(1) * at(1) + at(2) * at(2));
 }
 
-Vector3D Vector3D::operator-(const Vector3D& other) {
+Vector3D Vector3D::operator-(const Vector3D& other) const {
     return Vector3D(at(0) - other.at(0), at(1) - other.at(1), at(2) - other.at(2));
 }
 
-Vector3D Vector3D::cross_product(const Vector3D& vector) {
+Vector3D Vector3D::cross_product(const Vector3D& vector) const {
     return Vector3D(
             at(1) * vector.at(2) - at(2) * vector.at(1),
             at(2) * vector.at(0) - at(0) * vector.at(2),
@@ -28,10 +28,15 @@ public:
      */
     static Vector3D latlon_to_3d(const osmium::Location& from);
 
+    /**
+     * \brief Get the unit vector pointing from the centre of the earth to the location.
+     */
+    static Vector3D unit_vector(const osmium::Location& from);
+
     /**
      * subtraction
      */
-    Vector3D operator-(const Vector3D& other);
+    Vector3D operator-(const Vector3D& other) const;
 
     /**
      * \brief multiply with reciprocal of a scalar
@@ -50,12 +55,19 @@ public:
     /**
      * cross product
      */
-    Vector3D cross_product(const Vector3D& other);
+    Vector3D cross_product(const Vector3D& other) const;
+
+    /**
+     * dot product
+     */
+    double dot_product(const Vector3D& other) const {
+        return (*this)[0] * other[0] + (*this)[1] * other[1] + (*this)[2] * other[2];
+    }
 
     /**
      * \brief length of a vector
      */
-    double vector_length();
+    double vector_length() const;
 
     osmium::Location location();
 
@@ -6,51 +6,378 @@
  */
 
 #include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
 #include <exception>
+#include <fstream>
 #include <sstream>
+#include <stdexcept>
+#include <system_error>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include "way_admin_level_index.hpp"
 
+constexpr WayAdminLevelIndex::AdminLevel WayAdminLevelIndex::NO_LEVEL;
+constexpr size_t WayAdminLevelIndex::BLOCK_SIZE;
+constexpr size_t WayAdminLevelIndex::MAX_DENSE_SIZE_FACTOR;
+constexpr uint32_t WayAdminLevelIndex::FILE_VERSION;
+
+/// first bytes of a saved index
+static const char FILE_MAGIC[8] = {'O', 'S', 'M', 'A', 'D', 'M', 'L', 'V'};
+
+/**
+ * Round up to the next multiple of 8.
+ */
+static uint64_t align8(const uint64_t value) {
+    return (value + 7) & ~static_cast<uint64_t>(7);
+}
+
+WayAdminLevelIndex::~WayAdminLevelIndex() {
+    unmap();
+}
+
 void WayAdminLevelIndex::store(const osmium::object_id_type id, const AdminLevel admin_level) {
     m_way_idx.emplace_back(id, admin_level);
 }
 
-void WayAdminLevelIndex::prepare_for_query() {
+void WayAdminLevelIndex::prepare_for_query(const Layout layout) {
     std::sort(
         m_way_idx.begin(),
         m_way_idx.end(),
-        [](const std::pair<osmium::object_id_type, uint8_t>& lhs, const std::pair<osmium::object_id_type, uint8_t>& rhs) {
+        [](const IndexEntry& lhs, const IndexEntry& rhs) {
             return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
         }
     );
     // According to documentation, std::unique keeps the first element of a group of unique elements, i.e. the entry with
     // smallest admin_level among entries with equal OSM ID.
-    std::unique(
+    auto last = std::unique(
         m_way_idx.begin(),
         m_way_idx.end(),
-        [](const std::pair<osmium::object_id_type, uint8_t>& lhs, const std::pair<osmium::object_id_type, uint8_t>& rhs) {
+        [](const IndexEntry& lhs, const IndexEntry& rhs) {
             return lhs.first == rhs.first;
         }
     );
+    m_way_idx.erase(last, m_way_idx.end());
+    m_size = m_way_idx.size();
+    m_layout = layout;
+    if (m_layout == Layout::automatic) {
+        // The delta-coded layout is built first because its size is needed for the decision.
+        build_delta();
+        m_layout = Layout::delta;
+        if (!m_way_idx.empty()) {
+            const uint64_t range = static_cast<uint64_t>(m_way_idx.back().first - m_way_idx.front().first) + 1;
+            const size_t delta_bytes = m_deltas.size() + m_block_count * (sizeof(osmium::object_id_type)
+                    + sizeof(uint32_t));
+            if ((range + 1) / 2 <= MAX_DENSE_SIZE_FACTOR * delta_bytes) {
+                m_layout = Layout::dense;
+                clear_delta();
+            }
+        }
+    } else if (m_layout == Layout::delta) {
+        build_delta();
+    }
+    if (m_layout == Layout::dense) {
+        build_dense();
+    }
+    std::vector<IndexEntry>().swap(m_way_idx);
 }
 
-WayAdminLevelIndex::AdminLevel WayAdminLevelIndex::get(const osmium::object_id_type id, const AdminLevel fallback) {
-    std::pair<osmium::object_id_type, uint8_t> p {id, fallback};
-    auto it = std::lower_bound(
-        m_way_idx.begin(),
-        m_way_idx.end(),
-        p,
-        [](const std::pair<osmium::object_id_type, uint8_t>& lhs, const std::pair<osmium::object_id_type, uint8_t>& rhs) {
-            return lhs.first < rhs.first;
+void WayAdminLevelIndex::build_dense() {
+    unmap();
+    if (m_way_idx.empty()) {
+        return;
+    }
+    m_dense_first_id = m_way_idx.front().first;
+    const uint64_t range = static_cast<uint64_t>(m_way_idx.back().first - m_dense_first_id) + 1;
+    m_dense_bytes = static_cast<size_t>((range + 1) / 2);
+    // Anonymous mappings are zero-filled and pages are only allocated when they are written to.
+    void* mapping = mmap(nullptr, m_dense_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping == MAP_FAILED) {
+        m_dense_bytes = 0;
+        throw std::system_error{errno, std::system_category(), "Failed to allocate dense admin level index"};
+    }
+    m_mapping = mapping;
+    m_mapping_size = m_dense_bytes;
+    uint8_t* dense = static_cast<uint8_t*>(mapping);
+    for (const IndexEntry& entry : m_way_idx) {
+        const uint64_t offset = static_cast<uint64_t>(entry.first - m_dense_first_id);
+        dense[offset / 2] |= static_cast<uint8_t>((entry.second & 0x0f) << (4 * (offset % 2)));
+    }
+    m_dense = dense;
+}
+
+void WayAdminLevelIndex::build_delta() {
+    m_block_first_ids.clear();
+    m_block_offsets.clear();
+    m_deltas.clear();
+    osmium::object_id_type previous_id = 0;
+    for (size_t i = 0; i < m_way_idx.size(); ++i) {
+        uint64_t delta = 0;
+        if (i % BLOCK_SIZE == 0) {
+            m_block_first_ids.push_back(m_way_idx[i].first);
+            m_block_offsets.push_back(static_cast<uint32_t>(m_deltas.size()));
+        } else {
+            delta = static_cast<uint64_t>(m_way_idx[i].first - previous_id);
+        }
+        uint64_t value = (delta << 4) | (m_way_idx[i].second & 0x0f);
+        while (value >= 0x80) {
+            m_deltas.push_back(static_cast<uint8_t>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        m_deltas.push_back(static_cast<uint8_t>(value));
+        previous_id = m_way_idx[i].first;
+    }
+    m_block_first_ids.shrink_to_fit();
+    m_block_offsets.shrink_to_fit();
+    m_deltas.shrink_to_fit();
+    m_block_first_ids_data = m_block_first_ids.data();
+    m_block_offsets_data = m_block_offsets.data();
+    m_block_count = m_block_first_ids.size();
+    m_deltas_data = m_deltas.data();
+    m_deltas_size = m_deltas.size();
+}
+
+void WayAdminLevelIndex::clear_delta() {
+    std::vector<osmium::object_id_type>().swap(m_block_first_ids);
+    std::vector<uint32_t>().swap(m_block_offsets);
+    std::vector<uint8_t>().swap(m_deltas);
+    m_block_first_ids_data = nullptr;
+    m_block_offsets_data = nullptr;
+    m_block_count = 0;
+    m_deltas_data = nullptr;
+    m_deltas_size = 0;
+}
+
+void WayAdminLevelIndex::unmap() {
+    if (m_mapping) {
+        munmap(m_mapping, m_mapping_size);
+        m_mapping = nullptr;
+        m_mapping_size = 0;
+        m_dense = nullptr;
+        m_dense_bytes = 0;
+    }
+}
+
+WayAdminLevelIndex::AdminLevel WayAdminLevelIndex::find_in_block(const size_t block,
+        const osmium::object_id_type id, const AdminLevel fallback) const {
+    const uint8_t* pos = m_deltas_data + m_block_offsets_data[block];
+    const uint8_t* end = m_deltas_data
+            + (block + 1 < m_block_count ? m_block_offsets_data[block + 1] : m_deltas_size);
+    osmium::object_id_type current_id = m_block_first_ids_data[block];
+    while (pos < end) {
+        uint64_t value = 0;
+        int shift = 0;
+        do {
+            value |= static_cast<uint64_t>(*pos & 0x7f) << shift;
+            shift += 7;
+        } while (*pos++ & 0x80);
+        current_id += static_cast<osmium::object_id_type>(value >> 4);
+        if (current_id == id) {
+            const AdminLevel level = static_cast<AdminLevel>(value & 0x0f);
+            return level == NO_LEVEL ? fallback : level;
+        }
+        if (current_id > id) {
+            break;
         }
-    );
-    if (it != m_way_idx.end() && it->first == id) {
-        return it->second;
     }
     return fallback;
 }
 
-size_t WayAdminLevelIndex::size() {
-    return m_way_idx.size();
+WayAdminLevelIndex::AdminLevel WayAdminLevelIndex::get(const osmium::object_id_type id, const AdminLevel fallback) const {
+    if (m_layout == Layout::dense) {
+        if (!m_dense || id < m_dense_first_id) {
+            return fallback;
+        }
+        const uint64_t offset = static_cast<uint64_t>(id - m_dense_first_id);
+        if (offset / 2 >= m_dense_bytes) {
+            return fallback;
+        }
+        const AdminLevel level = static_cast<AdminLevel>((m_dense[offset / 2] >> (4 * (offset % 2))) & 0x0f);
+        return level == NO_LEVEL ? fallback : level;
+    }
+    size_t block = 0;
+    return get(id, block, fallback);
+}
+
+bool WayAdminLevelIndex::find_block(const osmium::object_id_type id, size_t& block) const {
+    const size_t count = m_block_count;
+    if (count == 0 || id < m_block_first_ids_data[0]) {
+        return false;
+    }
+    // Sequential lookups stay in the same block or continue in the next one.
+    for (size_t candidate = block; candidate < count && candidate <= block + 1; ++candidate) {
+        if (m_block_first_ids_data[candidate] <= id
+                && (candidate + 1 == count || id < m_block_first_ids_data[candidate + 1])) {
+            block = candidate;
+            return true;
+        }
+    }
+    const osmium::object_id_type* it = std::upper_bound(m_block_first_ids_data, m_block_first_ids_data + count, id);
+    block = static_cast<size_t>(it - m_block_first_ids_data) - 1;
+    return true;
+}
+
+WayAdminLevelIndex::AdminLevel WayAdminLevelIndex::get(const osmium::object_id_type id, size_t& position,
+        const AdminLevel fallback) const {
+    if (m_layout == Layout::dense) {
+        return get(id, fallback);
+    }
+    if (!find_block(id, position)) {
+        return fallback;
+    }
+    return find_in_block(position, id, fallback);
+}
+
+size_t WayAdminLevelIndex::size() const {
+    return m_size;
+}
+
+WayAdminLevelIndex::Layout WayAdminLevelIndex::layout() const {
+    return m_layout;
+}
+
+size_t WayAdminLevelIndex::used_memory() const {
+    return m_way_idx.capacity() * sizeof(IndexEntry) + m_mapping_size
+            + m_block_first_ids.capacity() * sizeof(osmium::object_id_type)
+            + m_block_offsets.capacity() * sizeof(uint32_t) + m_deltas.capacity();
+}
+
+WayAdminLevelIndex::Source WayAdminLevelIndex::source_of(const std::string& input_filename,
+        const AdminLevel max_level) {
+    struct stat file_stat;
+    if (stat(input_filename.c_str(), &file_stat) != 0) {
+        throw std::system_error{errno, std::system_category(), "Failed to get status of " + input_filename};
+    }
+    const int64_t mtime = static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1000000000
+            + static_cast<int64_t>(file_stat.st_mtim.tv_nsec);
+    return Source{static_cast<uint64_t>(file_stat.st_size), mtime, max_level};
+}
+
+void WayAdminLevelIndex::save(const std::string& filename, const Source& source) const {
+    static_assert(sizeof(FileHeader) % 8 == 0, "The arrays following the header have to be aligned.");
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.m_magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+    header.m_version = FILE_VERSION;
+    header.m_layout = static_cast<uint32_t>(m_layout);
+    header.m_input_file_size = source.m_file_size;
+    header.m_input_mtime = source.m_mtime;
+    header.m_max_level = source.m_max_level;
+    header.m_size = m_size;
+    header.m_dense_first_id = m_dense_first_id;
+    header.m_dense_bytes = m_dense_bytes;
+    header.m_block_count = m_block_count;
+    header.m_deltas_size = m_deltas_size;
+
+    const std::string tmp_filename = filename + ".tmp";
+    {
+        std::ofstream file {tmp_filename, std::ios::binary | std::ios::trunc};
+        const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        if (m_layout == Layout::dense) {
+            file.write(reinterpret_cast<const char*>(m_dense), static_cast<std::streamsize>(m_dense_bytes));
+        } else {
+            const uint64_t offsets_size = m_block_count * sizeof(uint32_t);
+            file.write(reinterpret_cast<const char*>(m_block_first_ids_data),
+                    static_cast<std::streamsize>(m_block_count * sizeof(osmium::object_id_type)));
+            file.write(reinterpret_cast<const char*>(m_block_offsets_data), static_cast<std::streamsize>(offsets_size));
+            file.write(padding, static_cast<std::streamsize>(align8(offsets_size) - offsets_size));
+            file.write(reinterpret_cast<const char*>(m_deltas_data), static_cast<std::streamsize>(m_deltas_size));
+        }
+        file.close();
+        if (!file) {
+            std::remove(tmp_filename.c_str());
+            throw std::runtime_error{"Failed to write admin level index to " + tmp_filename};
+        }
+    }
+    if (std::rename(tmp_filename.c_str(), filename.c_str()) != 0) {
+        std::remove(tmp_filename.c_str());
+        throw std::runtime_error{"Failed to rename " + tmp_filename + " to " + filename};
+    }
+}
+
+bool WayAdminLevelIndex::valid_block_offsets(const uint8_t* data, const uint64_t block_count,
+        const uint64_t deltas_size) {
+    if (block_count == 0) {
+        return deltas_size == 0;
+    }
+    const uint32_t* offsets = reinterpret_cast<const uint32_t*>(data + block_count * sizeof(osmium::object_id_type));
+    const uint8_t* deltas = data + block_count * sizeof(osmium::object_id_type)
+            + align8(block_count * sizeof(uint32_t));
+    // Every block has at least one entry. The last entry must not continue beyond the end.
+    if (offsets[0] != 0 || offsets[block_count - 1] >= deltas_size || (deltas[deltas_size - 1] & 0x80)) {
+        return false;
+    }
+    for (uint64_t i = 1; i < block_count; ++i) {
+        if (offsets[i] <= offsets[i - 1]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool WayAdminLevelIndex::load(const std::string& filename, const Source& source) {
+    const int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return false;
+    }
+    FileHeader header;
+    struct stat file_stat;
+    if (read(fd, &header, sizeof(header)) != static_cast<ssize_t>(sizeof(header)) || fstat(fd, &file_stat) != 0
+            || std::memcmp(header.m_magic, FILE_MAGIC, sizeof(FILE_MAGIC)) || header.m_version != FILE_VERSION
+            || header.m_input_file_size != source.m_file_size || header.m_input_mtime != source.m_mtime
+            || header.m_max_level != source.m_max_level) {
+        close(fd);
+        return false;
+    }
+    const Layout layout = static_cast<Layout>(header.m_layout);
+    uint64_t expected_size = sizeof(header);
+    if (layout == Layout::dense) {
+        expected_size += header.m_dense_bytes;
+    } else if (layout == Layout::delta) {
+        expected_size += header.m_block_count * sizeof(osmium::object_id_type)
+                + align8(header.m_block_count * sizeof(uint32_t)) + header.m_deltas_size;
+    } else {
+        close(fd);
+        throw std::runtime_error{"Invalid layout in admin level index " + filename};
+    }
+    if (static_cast<uint64_t>(file_stat.st_size) != expected_size) {
+        close(fd);
+        throw std::runtime_error{"Admin level index " + filename + " is truncated"};
+    }
+    void* mapping = mmap(nullptr, static_cast<size_t>(expected_size), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::system_error{errno, std::system_category(), "Failed to map admin level index " + filename};
+    }
+    if (layout == Layout::delta && !valid_block_offsets(static_cast<const uint8_t*>(mapping) + sizeof(header),
+            header.m_block_count, header.m_deltas_size)) {
+        munmap(mapping, static_cast<size_t>(expected_size));
+        throw std::runtime_error{"Admin level index " + filename + " has invalid block offsets"};
+    }
+    unmap();
+    m_mapping = mapping;
+    m_mapping_size = static_cast<size_t>(expected_size);
+    m_layout = layout;
+    m_size = static_cast<size_t>(header.m_size);
+    const uint8_t* data = static_cast<const uint8_t*>(mapping) + sizeof(header);
+    if (layout == Layout::dense) {
+        m_dense_first_id = header.m_dense_first_id;
+        m_dense = header.m_dense_bytes > 0 ? data : nullptr;
+        m_dense_bytes = static_cast<size_t>(header.m_dense_bytes);
+    } else {
+        m_block_count = static_cast<size_t>(header.m_block_count);
+        m_block_first_ids_data = reinterpret_cast<const osmium::object_id_type*>(data);
+        data += m_block_count * sizeof(osmium::object_id_type);
+        m_block_offsets_data = reinterpret_cast<const uint32_t*>(data);
+        data += align8(m_block_count * sizeof(uint32_t));
+        m_deltas_data = data;
+        m_deltas_size = static_cast<size_t>(header.m_deltas_size);
+    }
+    return true;
 }
 
 WayAdminLevelIndex::AdminLevel WayAdminLevelIndex::parse_admin_level(const char* admin_level) {
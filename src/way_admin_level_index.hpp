@@ -8,36 +8,248 @@
 #ifndef SRC_WAY_ADMIN_LEVEL_INDEX_HPP_
 #define SRC_WAY_ADMIN_LEVEL_INDEX_HPP_
 
+#include <cstdint>
+#include <string>
 #include <vector>
 #include <osmium/osm/types.hpp>
 
+/**
+ * \brief Admin levels of ways which are members of admin boundary relations.
+ *
+ * The entries are collected with store(). prepare_for_query() converts them into one of two
+ * layouts:
+ *
+ * - A dense array with 4 bits per way ID between the smallest and the largest ID. It is allocated
+ *   with mmap, pages without entries are never touched. Lookups are O(1).
+ * - A sorted list of entries whose IDs are delta-coded as variable length integers with the level
+ *   in the lower 4 bits. Every BLOCK_SIZE entries, a block starts with an absolute ID. Lookups
+ *   are a binary search on the blocks followed by a scan of a single block.
+ *
+ * If the layout is picked automatically, the dense array is only used if it is at most
+ * MAX_DENSE_SIZE_FACTOR times larger than the delta-coded list. This is the case for small
+ * extracts with densely packed IDs but not for the planet where only a small fraction of all ways
+ * are boundaries.
+ *
+ * A prepared index can be saved to a file and mapped into memory by other runs or tools. The file
+ * consists of a FileHeader followed by the arrays of the layout, each starting at a multiple of
+ * 8 bytes. The header records size and modification time (in nanoseconds) of the input file
+ * and the maximum admin level, a saved index is only loaded if they match. An input file which
+ * is replaced by a file of the same size within the timestamp resolution of the file system is
+ * not detected. Numbers are stored in the byte order of the machine.
+ */
 class WayAdminLevelIndex {
+public:
+    using AdminLevel = uint8_t;
+    static constexpr AdminLevel NO_LEVEL = 0;
+
+    /// layout of the index after prepare_for_query()
+    enum class Layout {
+        automatic,
+        dense,
+        delta
+    };
+
+    /// number of entries of a block of the delta-coded layout
+    static constexpr size_t BLOCK_SIZE = 16;
+
+    /// maximum ratio between the size of the dense array and the delta-coded list if the layout is
+    /// picked automatically
+    static constexpr size_t MAX_DENSE_SIZE_FACTOR = 2;
+
+    /**
+     * \brief Input the index has been built from.
+     */
+    struct Source {
+        uint64_t m_file_size;
+
+        /// modification time in nanoseconds since the epoch
+        int64_t m_mtime;
+
+        AdminLevel m_max_level;
+    };
+
+private:
+    /**
+     * \brief Header of a saved index.
+     */
+    struct FileHeader {
+        char m_magic[8];
+        uint32_t m_version;
+        uint32_t m_layout;
+        uint64_t m_input_file_size;
+        int64_t m_input_mtime;
+        uint32_t m_max_level;
+        uint32_t m_reserved;
+        uint64_t m_size;
+        int64_t m_dense_first_id;
+        uint64_t m_dense_bytes;
+        uint64_t m_block_count;
+        uint64_t m_deltas_size;
+    };
 
-    using IndexEntry = std::pair<osmium::object_id_type, uint8_t>;
+    /// version of the file format, to be increased on every incompatible change
+    static constexpr uint32_t FILE_VERSION = 2;
+
+    using IndexEntry = std::pair<osmium::object_id_type, AdminLevel>;
+
+    /// entries added by store(), cleared by prepare_for_query()
     std::vector<IndexEntry> m_way_idx;
 
+    Layout m_layout = Layout::automatic;
+
+    /// number of ways in the index
+    size_t m_size = 0;
+
+    /// ID of the way whose level is stored in the lower half of the first byte of m_dense
+    osmium::object_id_type m_dense_first_id = 0;
+
+    /// anonymous mapping of the dense array or mapping of a loaded file
+    void* m_mapping = nullptr;
+
+    /// size of m_mapping in bytes
+    size_t m_mapping_size = 0;
+
+    /// dense array, two levels per byte
+    const uint8_t* m_dense = nullptr;
+
+    /// size of m_dense in bytes
+    size_t m_dense_bytes = 0;
+
+    /// storage of m_block_first_ids_data if the index has been built by this instance
+    std::vector<osmium::object_id_type> m_block_first_ids;
+
+    /// storage of m_block_offsets_data if the index has been built by this instance
+    std::vector<uint32_t> m_block_offsets;
+
+    /// storage of m_deltas_data if the index has been built by this instance
+    std::vector<uint8_t> m_deltas;
+
+    /// ID of the first entry of each block
+    const osmium::object_id_type* m_block_first_ids_data = nullptr;
+
+    /// offset of the first entry of each block in m_deltas_data
+    const uint32_t* m_block_offsets_data = nullptr;
+
+    /// number of blocks
+    size_t m_block_count = 0;
+
+    /// variable length entries (delta to the previous ID << 4 | level)
+    const uint8_t* m_deltas_data = nullptr;
+
+    /// size of m_deltas_data in bytes
+    size_t m_deltas_size = 0;
+
+    void build_dense();
+
+    void build_delta();
+
+    /**
+     * Release the arrays of the delta-coded layout.
+     */
+    void clear_delta();
+
+    void unmap();
+
+    /**
+     * Check the block offsets of a saved delta-coded index.
+     *
+     * \param data start of the arrays following the file header
+     */
+    static bool valid_block_offsets(const uint8_t* data, const uint64_t block_count, const uint64_t deltas_size);
+
+    /**
+     * Find the block of the delta-coded layout which might contain a way.
+     *
+     * \param id ID of the way
+     * \param block block where the way is expected, will be set to the block found
+     *
+     * \returns false if the ID is smaller than the first ID of the index
+     */
+    bool find_block(const osmium::object_id_type id, size_t& block) const;
+
+    /**
+     * Find the level of a way in a block of the delta-coded layout.
+     */
+    AdminLevel find_in_block(const size_t block, const osmium::object_id_type id, const AdminLevel fallback) const;
+
 public:
-    using AdminLevel = uint8_t;
-    static constexpr AdminLevel NO_LEVEL = 0;
+    WayAdminLevelIndex() = default;
+
+    ~WayAdminLevelIndex();
+
+    WayAdminLevelIndex(const WayAdminLevelIndex&) = delete;
+    WayAdminLevelIndex& operator=(const WayAdminLevelIndex&) = delete;
 
     /**
      * Add way ID and the admin level of the relation using it to the index.
      * If the way is already present in the index, update the admin_level if the stored value is
      * larger than the new value.
+     *
+     * This method must not be called after prepare_for_query().
      */
     void store(const osmium::object_id_type id, const AdminLevel admin_level);
 
     /**
-     * Prepare index for querying by sorting it and removing duplicates.
+     * Prepare index for querying by sorting it, removing duplicates and converting it into the
+     * requested layout.
      */
-    void prepare_for_query();
+    void prepare_for_query(const Layout layout = Layout::automatic);
 
     /**
      * Get admin level stored in the index.
      */
-    AdminLevel get(const osmium::object_id_type id, const AdminLevel fallback = NO_LEVEL);
+    AdminLevel get(const osmium::object_id_type id, const AdminLevel fallback = NO_LEVEL) const;
 
-    size_t size();
+    /**
+     * Get admin level stored in the index.
+     *
+     * Lookups are expected in the order of the way IDs. The caller keeps the position where the
+     * next lookup starts. If the lookups are in a different order, a binary search is used.
+     *
+     * \param id ID of the way
+     * \param position position of the next lookup, updated by this method, start with 0
+     * \param fallback value returned if the way is not in the index
+     */
+    AdminLevel get(const osmium::object_id_type id, size_t& position, const AdminLevel fallback = NO_LEVEL) const;
+
+    size_t size() const;
+
+    /**
+     * Get size and modification time of an input file.
+     *
+     * \throws std::system_error if the file does not exist
+     */
+    static Source source_of(const std::string& input_filename, const AdminLevel max_level);
+
+    /**
+     * Save the prepared index to a file. The file is written under a temporary name and renamed
+     * afterwards, therefore readers never see an incomplete file.
+     *
+     * \throws std::runtime_error if the file cannot be written
+     */
+    void save(const std::string& filename, const Source& source) const;
+
+    /**
+     * Map a saved index into memory. The index must be empty.
+     *
+     * \returns false if the file does not exist, has an unknown format or has been built from a
+     * different input
+     *
+     * \throws std::runtime_error if the file is truncated, has invalid block offsets or cannot be
+     * mapped
+     */
+    bool load(const std::string& filename, const Source& source);
+
+    /**
+     * Get the layout chosen by prepare_for_query().
+     */
+    Layout layout() const;
+
+    /**
+     * Get the number of bytes used by the index. Pages of the dense array and of a loaded file are
+     * counted even if they have not been touched.
+     */
+    size_t used_memory() const;
 
     /**
      * Parse value of admin_level key from string. Returns 0 for failures.
@@ -0,0 +1,51 @@
+/*
+ * way_id_set.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include <algorithm>
+#include "way_id_set.hpp"
+
+void WayIdSet::insert(const osmium::object_id_type id) {
+    m_ids.push_back(id);
+}
+
+void WayIdSet::sort() {
+    std::sort(m_ids.begin(), m_ids.end());
+    m_ids.erase(std::unique(m_ids.begin(), m_ids.end()), m_ids.end());
+    m_ids.shrink_to_fit();
+    m_sorted_count = m_ids.size();
+}
+
+bool WayIdSet::contains(const osmium::object_id_type id, size_t& position) const {
+    size_t pos = std::min(position, m_sorted_count);
+    const bool after_previous = pos == 0 || m_ids[pos - 1] < id;
+    const bool before_next = pos == m_sorted_count || m_ids[pos] >= id;
+    if (!after_previous) {
+        pos = std::lower_bound(m_ids.cbegin(), m_ids.cbegin() + pos, id) - m_ids.cbegin();
+    } else if (!before_next) {
+        // Ways without an entry are skipped. The next entries are usually close.
+        while (pos < m_sorted_count && pos < position + 8 && m_ids[pos] < id) {
+            ++pos;
+        }
+        if (pos < m_sorted_count && m_ids[pos] < id) {
+            pos = std::lower_bound(m_ids.cbegin() + pos, m_ids.cbegin() + m_sorted_count, id) - m_ids.cbegin();
+        }
+    }
+    const bool found = pos < m_sorted_count && m_ids[pos] == id;
+    position = found ? pos + 1 : pos;
+    return found;
+}
+
+bool WayIdSet::contains(const osmium::object_id_type id) const {
+    return std::binary_search(m_ids.cbegin(), m_ids.cbegin() + m_sorted_count, id);
+}
+
+size_t WayIdSet::size() const {
+    return m_sorted_count;
+}
+
+size_t WayIdSet::used_memory() const {
+    return m_ids.capacity() * sizeof(osmium::object_id_type);
+}
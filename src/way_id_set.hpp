@@ -0,0 +1,58 @@
+/*
+ * way_id_set.hpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#ifndef SRC_WAY_ID_SET_HPP_
+#define SRC_WAY_ID_SET_HPP_
+
+#include <vector>
+#include <osmium/osm/types.hpp>
+
+/**
+ * \brief Set of way IDs stored in a sorted vector.
+ *
+ * The set is filled first and sorted once afterwards. Lookups are expected in the order of the
+ * way IDs. The caller keeps the position where the next lookup starts. If the lookups are in a
+ * different order, a binary search is used.
+ */
+class WayIdSet {
+    std::vector<osmium::object_id_type> m_ids;
+
+    /// IDs before this position are sorted and unique.
+    size_t m_sorted_count = 0;
+
+public:
+    /**
+     * Add an ID. It is not found by contains() before sort() has been called.
+     */
+    void insert(const osmium::object_id_type id);
+
+    /**
+     * Sort the IDs and remove duplicates.
+     */
+    void sort();
+
+    /**
+     * Check if the set contains an ID.
+     *
+     * \param id ID to look for
+     * \param position position of the next lookup, updated by this method, start with 0
+     */
+    bool contains(const osmium::object_id_type id, size_t& position) const;
+
+    /**
+     * Check if the set contains an ID using a binary search.
+     */
+    bool contains(const osmium::object_id_type id) const;
+
+    size_t size() const;
+
+    /**
+     * Get the number of bytes used by the set.
+     */
+    size_t used_memory() const;
+};
+
+#endif /* SRC_WAY_ID_SET_HPP_ */
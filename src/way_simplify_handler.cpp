@@ -9,38 +9,27 @@
 #include "way_simplify_handler.hpp"
 #include "distance_sphere_plain.hpp"
 
-WaySimplifyHandler::WaySimplifyHandler(double epsilon, std::vector<BoundarySegment>& segments,
-        std::unordered_set<osmium::object_id_type>& treat_as_rings_way) :
+WaySimplifyHandler::WaySimplifyHandler(double epsilon, BoundarySegmentStore& segments,
+        const WayIdSet& treat_as_rings_way, KeptNodesIndex& kept_nodes_index) :
         AbstractWaySimplifier(epsilon),
         m_segments(segments),
-        m_treat_as_rings_way(treat_as_rings_way) { }
+        m_treat_as_rings_way(treat_as_rings_way),
+        m_kept_nodes_index(kept_nodes_index) { }
 
 void WaySimplifyHandler::add_simplified_node_list(const osmium::WayNodeList& node_list, osmium::object_id_type way_id) {
-    // vector for kept node references; entrys which are nullptr mean that we discard these nodes
-    std::vector<const osmium::NodeRef*> kept_node_refs {node_list.size(), nullptr};
     // We don't discard the first and last node
-    kept_node_refs.front() = &(node_list.front());
-    kept_node_refs.back() = &(node_list.back());
+    start_way(node_list);
 
     // simplify the node list
-    if (node_list.front() == node_list.back() || m_treat_as_rings_way.count(way_id) == 1) {
-        // the way is a ring
-        simplify_closed_ring(node_list, kept_node_refs);
-    } else {
-        simplify_node_list(node_list, kept_node_refs, 0, node_list.size() - 1);
-    }
+    simplify_way(node_list.front() == node_list.back() || m_treat_as_rings_way.contains(way_id, m_treat_as_rings_position));
+    m_kept_nodes_index.add_way(way_id, m_kept);
 
-    // add node references to the to final object
-    for (size_t i = 0; i != kept_node_refs.size() - 1; ++i) {
-        if (kept_node_refs.at(i)) {
-            // find next non-NULL node reference
-            for (size_t j = i+1; j != kept_node_refs.size(); ++j) {
-                if (kept_node_refs.at(j)) {
-                    m_segments.emplace_back(kept_node_refs.at(i)->location(), kept_node_refs.at(j)->location(), way_id, i, j);
-                    i = j - 1; // set forward. To compensate the auto-increment of the for loop, we have to decrement here by 1.
-                    break;
-                }
-            }
+    // add a segment between every pair of consecutive kept nodes
+    size_t previous = 0;
+    for (size_t i = 1; i != m_kept.size(); ++i) {
+        if (m_kept[i]) {
+            m_segments.emplace_back(node_list[previous].location(), node_list[i].location(), way_id, previous, i);
+            previous = i;
         }
     }
 }
@@ -8,17 +8,24 @@
 #ifndef SRC_WAY_SIMPLIFY_HANDLER_HPP_
 #define SRC_WAY_SIMPLIFY_HANDLER_HPP_
 
-#include <unordered_set>
-#include "boundary_segment.hpp"
+#include "boundary_segment_store.hpp"
 #include "abstract_way_simplifier.hpp"
+#include "kept_nodes_index.hpp"
+#include "way_id_set.hpp"
 
 #include "distance_sphere_plain.hpp"
 
 class WaySimplifyHandler : public AbstractWaySimplifier {
 protected:
-    std::vector<BoundarySegment>& m_segments;
+    BoundarySegmentStore& m_segments;
 
-    std::unordered_set<osmium::object_id_type>& m_treat_as_rings_way;
+    const WayIdSet& m_treat_as_rings_way;
+
+    /// position in m_treat_as_rings_way where the next lookup starts
+    size_t m_treat_as_rings_position = 0;
+
+    /// nodes kept by the simplification, used by the last pass
+    KeptNodesIndex& m_kept_nodes_index;
 
     /**
      * ID the next node reference we will write to the output file will get
@@ -28,8 +35,8 @@ protected:
     void add_simplified_node_list(const osmium::WayNodeList& node_list, osmium::object_id_type way_id);
 
 public:
-    WaySimplifyHandler(double epsilon, std::vector<BoundarySegment>& segments,
-            std::unordered_set<osmium::object_id_type>& treat_as_rings_way);
+    WaySimplifyHandler(double epsilon, BoundarySegmentStore& segments,
+            const WayIdSet& treat_as_rings_way, KeptNodesIndex& kept_nodes_index);
 
     void way(const osmium::Way& way);
 };
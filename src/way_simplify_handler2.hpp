@@ -8,46 +8,53 @@
 #ifndef SRC_WAY_SIMPLIFY_HANDLER2_HPP_
 #define SRC_WAY_SIMPLIFY_HANDLER2_HPP_
 
-#include <unordered_set>
+#include <string>
+#include <osmium/handler.hpp>
 #include <osmium/io/writer.hpp>
 #include <osmium/io/any_output.hpp>
-#include <osmium/builder/osm_object_builder.hpp>
-#include "abstract_way_simplifier.hpp"
+#include "boundary_way_store.hpp"
+#include "kept_nodes_index.hpp"
 #include "no_simplify_segment.hpp"
+#include "node_id_set.hpp"
+#include "output_spool.hpp"
+#include "simplified_way_builder.hpp"
+#include "way_id_set.hpp"
 
-class WaySimplifyHandler2 : public AbstractWaySimplifier {
+class WaySimplifyHandler2 : public osmium::handler::Handler {
     osmium::io::Writer m_writer;
+    double m_epsilon;
     ErrorsMap& m_error_segments;
     KeepNodesMap& m_kept_nodes;
-    std::unordered_set<osmium::object_id_type>& m_treat_as_rings_way;
-    osmium::memory::Buffer m_output_buffer;
 
-    void add_kept_nodes_to_list(const osmium::WayNodeList& nodes, const osmium::object_id_type way_id,
-            std::vector<const osmium::NodeRef*>& kept_nodes);
+    /// nodes kept by the simplification in pass 3
+    KeptNodesIndex& m_kept_nodes_index;
+    const WayIdSet& m_treat_as_rings_way;
 
-    void add_all_nodes(osmium::memory::Buffer& buffer, osmium::builder::Builder* builder,
-            const osmium::WayNodeList& node_list);
+    /// nodes which have been added to an output buffer
+    NodeIdSet m_written_nodes;
 
-    void add_tags(osmium::memory::Buffer& buffer, osmium::builder::Builder* builder, const osmium::TagList& tags);
+    /// simplified ways and their nodes waiting to be written
+    OutputSpool m_spool;
 
-    /**
-     * \brief add this node to the output buffer
-     *
-     * Don't forget to commit after calling this method.
-     */
-    void add_node_to_buffer(const osmium::NodeRef* nd_ref);
+    osmium::memory::Buffer m_output_buffer;
+
+    /// builder of the ways passed to way(), writes into m_output_buffer
+    SimplifiedWayBuilder m_builder;
 
-    /***
-     * \brief Sort the nodes and ways in the output buffer by item type, ID and version.
+    bool m_reached_relations = false;
+
+    /**
+     * \brief Write all nodes and ways collected by the spool to the output file.
      *
-     * Duplicated items will be written only one time.
+     * Nodes are sorted by ID and duplicated nodes will be written only one time.
      */
-    void sort_buffer_and_write_it();
+    void write_nodes_and_ways();
 
 public:
     WaySimplifyHandler2(osmium::io::File& outfile, double epsilon,
             const osmium::io::Header& header, ErrorsMap& error_segments, KeepNodesMap& keep_nodes,
-            std::unordered_set<osmium::object_id_type>& treat_as_rings_way);
+            KeptNodesIndex& kept_nodes_index, const WayIdSet& treat_as_rings_way,
+            const std::string& tmp_directory, const size_t memory_budget);
 
     ~WaySimplifyHandler2();
 
@@ -56,17 +63,17 @@ public:
     void relation(const osmium::Relation& relation);
 
     /**
-     * Simplify a way but keeping essential nodes to prevent intersections.
+     * \brief Simplify all ways of the store using multiple threads and write them and their nodes.
      *
-     * \param buffer output buffer
-     * \param builder Osmium object builder
-     * \param node_list node list of the way
-     * \param way_id ID of the way
+     * Every way buffer is simplified by its own SimplifiedWayBuilder. At most one output buffer per
+     * thread is kept in memory. They are passed to the spool in the order of the way buffers. Ways
+     * which are not kept in the store are read from the input file again and built by the calling
+     * thread. This method has to be called before any relation is passed to this handler.
      *
-     * \returns list of nodes which have not been removed by the simplification
+     * \param way_store ways to simplify
+     * \param threads number of threads
      */
-    void add_simplified_node_list(osmium::memory::Buffer& buffer, osmium::builder::Builder* builder,
-            const osmium::WayNodeList& node_list, osmium::object_id_type way_id, std::vector<const osmium::NodeRef*>& kept_node_refs);
+    void write_ways(BoundaryWayStore& way_store, const unsigned int threads);
 };
 
 
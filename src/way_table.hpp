@@ -0,0 +1,143 @@
+/*
+ * way_table.hpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#ifndef SRC_WAY_TABLE_HPP_
+#define SRC_WAY_TABLE_HPP_
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <osmium/osm/types.hpp>
+
+/**
+ * \brief Values attached to ways, stored in a single vector sorted by way ID and value.
+ *
+ * Entries are appended at the end and become visible to lookups after sort() has been called.
+ * Lookups are expected in the order of the way IDs. The caller keeps the position where the
+ * next lookup starts. If the lookups are in a different order, a binary search is used.
+ *
+ * TValue has to provide operator<.
+ */
+template <typename TValue>
+class WayTable {
+public:
+    using value_type = std::pair<osmium::object_id_type, TValue>;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+
+private:
+    std::vector<value_type> m_entries;
+
+    /// Entries before this position are sorted.
+    size_t m_sorted_count = 0;
+
+    static bool less(const value_type& lhs, const value_type& rhs) {
+        return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second < rhs.second);
+    }
+
+    /**
+     * Get the position of the first entry of a way.
+     *
+     * \param way_id ID of the way
+     * \param hint position where the entries of the way are expected
+     */
+    size_t lower_bound(const osmium::object_id_type way_id, const size_t hint) const {
+        const size_t pos = std::min(hint, m_sorted_count);
+        const bool after_previous = pos == 0 || m_entries[pos - 1].first < way_id;
+        const bool before_next = pos == m_sorted_count || m_entries[pos].first >= way_id;
+        if (after_previous && before_next) {
+            return pos;
+        }
+        const auto compare = [](const value_type& entry, const osmium::object_id_type id) {
+            return entry.first < id;
+        };
+        if (after_previous) {
+            return std::lower_bound(m_entries.cbegin() + pos, m_entries.cbegin() + m_sorted_count, way_id, compare)
+                    - m_entries.cbegin();
+        }
+        return std::lower_bound(m_entries.cbegin(), m_entries.cbegin() + pos, way_id, compare) - m_entries.cbegin();
+    }
+
+    /**
+     * Get the positions of the first entry of a way and after its last entry and update the position
+     * of the next lookup.
+     */
+    std::pair<size_t, size_t> find(const osmium::object_id_type way_id, size_t& position) const {
+        const size_t begin = lower_bound(way_id, position);
+        size_t end = begin;
+        while (end < m_sorted_count && m_entries[end].first == way_id) {
+            ++end;
+        }
+        position = end;
+        return std::make_pair(begin, end);
+    }
+
+public:
+    /**
+     * Add a value. It is not found by equal_range() before sort() has been called.
+     */
+    void insert(const osmium::object_id_type way_id, const TValue& value) {
+        m_entries.emplace_back(way_id, value);
+    }
+
+    /**
+     * Sort the entries added since the last call of this method and merge them with the older ones.
+     */
+    void sort() {
+        if (m_sorted_count == m_entries.size()) {
+            return;
+        }
+        std::sort(m_entries.begin() + m_sorted_count, m_entries.end(), less);
+        std::inplace_merge(m_entries.begin(), m_entries.begin() + m_sorted_count, m_entries.end(), less);
+        m_sorted_count = m_entries.size();
+    }
+
+    /**
+     * Get all sorted entries of a way.
+     *
+     * \param way_id ID of the way
+     * \param position position of the next lookup, updated by this method, start with 0
+     */
+    std::pair<iterator, iterator> equal_range(const osmium::object_id_type way_id, size_t& position) {
+        const std::pair<size_t, size_t> range = find(way_id, position);
+        return std::make_pair(m_entries.begin() + range.first, m_entries.begin() + range.second);
+    }
+
+    std::pair<const_iterator, const_iterator> equal_range(const osmium::object_id_type way_id, size_t& position) const {
+        const std::pair<size_t, size_t> range = find(way_id, position);
+        return std::make_pair(m_entries.cbegin() + range.first, m_entries.cbegin() + range.second);
+    }
+
+    /**
+     * Get the number of entries of a way.
+     *
+     * This method scans all entries. It is intended for statistics and tests only.
+     */
+    size_t count(const osmium::object_id_type way_id) const {
+        return static_cast<size_t>(std::count_if(m_entries.cbegin(), m_entries.cend(),
+                [way_id](const value_type& entry) {
+            return entry.first == way_id;
+        }));
+    }
+
+    size_t size() const {
+        return m_entries.size();
+    }
+
+    bool empty() const {
+        return m_entries.empty();
+    }
+
+    const_iterator begin() const {
+        return m_entries.cbegin();
+    }
+
+    const_iterator end() const {
+        return m_entries.cend();
+    }
+};
+
+#endif /* SRC_WAY_TABLE_HPP_ */
@@ -48,16 +48,18 @@ namespace test_douglas_peucker{
     void simplify_node_list(const osmium::WayNodeList& node_list, std::vector<const osmium::NodeRef*>& kept_node_refs,
         size_t segment_start_offset, size_t segment_end_offset) {
         osmium::io::File outfile ("/tmp/test.osm");
-        std::vector<BoundarySegment> segments;
-        std::unordered_set<osmium::object_id_type> treat_as_rings_way;
-        WaySimplifyHandler handler (75, segments, treat_as_rings_way);
+        BoundarySegmentStore segments;
+        WayIdSet treat_as_rings_way;
+        KeptNodesIndex kept_nodes_index;
+        WaySimplifyHandler handler (75, segments, treat_as_rings_way, kept_nodes_index);
         handler.simplify_node_list(node_list, kept_node_refs, segment_start_offset, segment_end_offset);
     }
     void simplify_node_list_area(const osmium::WayNodeList& node_list, std::vector<const osmium::NodeRef*>& kept_node_refs) {
         osmium::io::File outfile ("/tmp/test.osm");
-        std::vector<BoundarySegment> segments;
-        std::unordered_set<osmium::object_id_type> treat_as_rings_way;
-        WaySimplifyHandler handler (75, segments, treat_as_rings_way);
+        BoundarySegmentStore segments;
+        WayIdSet treat_as_rings_way;
+        KeptNodesIndex kept_nodes_index;
+        WaySimplifyHandler handler (75, segments, treat_as_rings_way, kept_nodes_index);
         handler.simplify_node_list(node_list, kept_node_refs, 0, node_list.size() - 1);
     }
 
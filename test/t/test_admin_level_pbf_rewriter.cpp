@@ -0,0 +1,300 @@
+/*
+ * test_admin_level_pbf_rewriter.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <protozero/pbf_reader.hpp>
+#include <protozero/pbf_writer.hpp>
+#include <zlib.h>
+#include <osmium/io/any_input.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/util/progress_bar.hpp>
+#include <osmium/visitor.hpp>
+#include <admin_level_pbf_rewriter.hpp>
+#include <admin_rel_handlers.hpp>
+
+using StringTable = std::vector<std::string>;
+using Tags = std::vector<std::pair<uint32_t, uint32_t>>;
+
+static std::string make_blob(const std::string& type, const std::string& content) {
+    uLongf compressed_size = compressBound(static_cast<uLong>(content.size()));
+    std::string compressed (compressed_size, '\0');
+    compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressed_size,
+            reinterpret_cast<const Bytef*>(content.data()), static_cast<uLong>(content.size()), Z_DEFAULT_COMPRESSION);
+    compressed.resize(compressed_size);
+    std::string blob;
+    protozero::pbf_writer blob_writer {blob};
+    blob_writer.add_int32(2, static_cast<int32_t>(content.size()));
+    blob_writer.add_bytes(3, compressed);
+    std::string header;
+    protozero::pbf_writer header_writer {header};
+    header_writer.add_string(1, type);
+    header_writer.add_int32(3, static_cast<int32_t>(blob.size()));
+    std::string result;
+    const uint32_t header_size = static_cast<uint32_t>(header.size());
+    result.push_back(static_cast<char>((header_size >> 24) & 0xff));
+    result.push_back(static_cast<char>((header_size >> 16) & 0xff));
+    result.push_back(static_cast<char>((header_size >> 8) & 0xff));
+    result.push_back(static_cast<char>(header_size & 0xff));
+    return result + header + blob;
+}
+
+static std::string make_header_blob(const std::string& required_feature) {
+    std::string block;
+    protozero::pbf_writer writer {block};
+    writer.add_string(4, "OsmSchema-V0.6");
+    writer.add_string(4, required_feature);
+    writer.add_string(5, "Sort.Type_then_ID");
+    writer.add_string(16, "test_writer");
+    writer.add_string(17, "test_source");
+    writer.add_int64(32, 1700000000);
+    writer.add_int64(33, 4711);
+    writer.add_string(34, "https://example.org/replication/");
+    return make_blob("OSMHeader", block);
+}
+
+static void add_tags(protozero::pbf_writer& writer, const Tags& tags) {
+    std::vector<uint32_t> keys;
+    std::vector<uint32_t> vals;
+    for (const auto& tag : tags) {
+        keys.push_back(tag.first);
+        vals.push_back(tag.second);
+    }
+    writer.add_packed_uint32(2, keys.cbegin(), keys.cend());
+    writer.add_packed_uint32(3, vals.cbegin(), vals.cend());
+}
+
+/**
+ * Build a data blob with one primitive group.
+ */
+static std::string make_data_blob(const StringTable& strings, const protozero::pbf_tag_type field,
+        const std::vector<std::string>& objects) {
+    std::string string_table;
+    protozero::pbf_writer string_table_writer {string_table};
+    for (const std::string& str : strings) {
+        string_table_writer.add_bytes(1, str);
+    }
+    std::string group;
+    protozero::pbf_writer group_writer {group};
+    for (const std::string& object : objects) {
+        group_writer.add_message(field, object);
+    }
+    std::string block;
+    protozero::pbf_writer writer {block};
+    writer.add_message(1, string_table);
+    writer.add_message(2, group);
+    return make_blob("OSMData", block);
+}
+
+static std::string make_node(const int64_t id) {
+    std::string node;
+    protozero::pbf_writer writer {node};
+    writer.add_sint64(1, id);
+    writer.add_sint64(8, 480000000 + id);
+    writer.add_sint64(9, 90000000 + id);
+    return node;
+}
+
+static std::string make_way(const int64_t id, const Tags& tags) {
+    std::string way;
+    protozero::pbf_writer writer {way};
+    writer.add_int64(1, id);
+    add_tags(writer, tags);
+    // delta-coded references of the nodes 1 and 2
+    const std::vector<int64_t> refs {1, 1};
+    writer.add_packed_sint64(8, refs.cbegin(), refs.cend());
+    return way;
+}
+
+static std::string make_relation(const int64_t id, const Tags& tags, const std::vector<int64_t>& way_ids) {
+    std::string relation;
+    protozero::pbf_writer writer {relation};
+    writer.add_int64(1, id);
+    add_tags(writer, tags);
+    std::vector<int32_t> roles;
+    std::vector<int64_t> member_ids;
+    std::vector<int32_t> types;
+    int64_t previous = 0;
+    for (const int64_t way_id : way_ids) {
+        roles.push_back(0);
+        member_ids.push_back(way_id - previous);
+        types.push_back(1);
+        previous = way_id;
+    }
+    writer.add_packed_int32(8, roles.cbegin(), roles.cend());
+    writer.add_packed_sint64(9, member_ids.cbegin(), member_ids.cend());
+    writer.add_packed_int32(10, types.cbegin(), types.cend());
+    return relation;
+}
+
+/**
+ * Build a sorted file with a node blob, three way blobs and a relation blob.
+ */
+static std::string make_file(const std::string& required_feature) {
+    const StringTable strings {"", "highway", "residential", "boundary", "administrative", "admin_level", "6", "8",
+        "name", "Somewhere", "4", "type", "track"};
+    std::string content = make_header_blob(required_feature);
+    content += make_data_blob(strings, 1, {make_node(1), make_node(2)});
+    // way 10 gets admin_level=4, way 11 is not changed
+    content += make_data_blob(strings, 3, {make_way(10, {}), make_way(11, {{1, 2}})});
+    // no way of this blob is changed
+    content += make_data_blob(strings, 3, {make_way(12, {{1, 12}}), make_way(13, {{1, 2}})});
+    // way 14 gets admin_level=4, way 15 loses its tags, way 16 is not changed
+    content += make_data_blob(strings, 3, {make_way(14, {{3, 4}, {5, 6}, {8, 9}}), make_way(15, {{5, 7}, {3, 4}}),
+        make_way(16, {{5, 10}, {3, 4}})});
+    content += make_data_blob(strings, 4, {make_relation(100, {{11, 3}, {3, 4}, {5, 10}}, {10, 14, 16})});
+    return content;
+}
+
+static void write_file(const std::string& filename, const std::string& content) {
+    std::ofstream file {filename, std::ios::binary};
+    file << content;
+}
+
+static void fill(WayAdminLevelIndex& index) {
+    index.store(10, 4);
+    index.store(14, 4);
+    index.store(16, 4);
+    index.prepare_for_query();
+}
+
+static osmium::memory::Buffer read_all(const std::string& filename) {
+    osmium::memory::Buffer result {1024, osmium::memory::Buffer::auto_grow::yes};
+    osmium::io::Reader reader {filename};
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        for (auto it = buffer.cbegin<osmium::OSMObject>(); it != buffer.cend<osmium::OSMObject>(); ++it) {
+            result.add_item(*it);
+            result.commit();
+        }
+    }
+    reader.close();
+    return result;
+}
+
+static std::vector<std::pair<std::string, std::string>> tags_of(const osmium::OSMObject& object) {
+    std::vector<std::pair<std::string, std::string>> result;
+    for (const osmium::Tag& tag : object.tags()) {
+        result.emplace_back(tag.key(), tag.value());
+    }
+    return result;
+}
+
+TEST_CASE("Rewriting a PBF file block by block") {
+    const std::string input_filename = "test_admin_level_pbf_rewriter.osm.pbf";
+    const std::string output_filename = "test_admin_level_pbf_rewriter_out.osm.pbf";
+    const std::string content = make_file("DenseNodes");
+    write_file(input_filename, content);
+    WayAdminLevelIndex index;
+    fill(index);
+    osmium::ProgressBar progress_bar {0, false};
+    {
+        AdminLevelPbfRewriter rewriter {index, 10, input_filename, output_filename, "test_generator"};
+        rewriter.run(progress_bar);
+        REQUIRE(rewriter.copied_blob_count() == 3);
+        REQUIRE(rewriter.rewritten_blob_count() == 2);
+    }
+    PbfBlobLocator input {input_filename};
+    PbfBlobLocator output {output_filename};
+    REQUIRE(output.sorted());
+    REQUIRE(output.data_blobs().size() == 5);
+
+    SECTION("Blocks without changed ways are copied byte by byte") {
+        for (const size_t i : {0, 2, 4}) {
+            REQUIRE(output.raw_blobs(i, i + 1) == input.raw_blobs(i, i + 1));
+        }
+        for (const size_t i : {1, 3}) {
+            REQUIRE(output.raw_blobs(i, i + 1) != input.raw_blobs(i, i + 1));
+        }
+    }
+
+    SECTION("Header fields are copied except the writing program") {
+        const std::string block = output.header_block();
+        std::vector<std::string> features;
+        std::string writing_program;
+        std::string source;
+        int64_t timestamp = 0;
+        int64_t sequence_number = 0;
+        std::string base_url;
+        protozero::pbf_reader message {block.data(), block.size()};
+        while (message.next()) {
+            switch (message.tag()) {
+            case 4:
+            case 5:
+                features.push_back(message.get_string());
+                break;
+            case 16:
+                writing_program = message.get_string();
+                break;
+            case 17:
+                source = message.get_string();
+                break;
+            case 32:
+                timestamp = message.get_int64();
+                break;
+            case 33:
+                sequence_number = message.get_int64();
+                break;
+            case 34:
+                base_url = message.get_string();
+                break;
+            default:
+                message.skip();
+            }
+        }
+        REQUIRE(features == std::vector<std::string>({"OsmSchema-V0.6", "DenseNodes", "Sort.Type_then_ID"}));
+        REQUIRE(writing_program == "test_generator");
+        REQUIRE(source == "test_source");
+        REQUIRE(timestamp == 1700000000);
+        REQUIRE(sequence_number == 4711);
+        REQUIRE(base_url == "https://example.org/replication/");
+    }
+
+    SECTION("Result equals the output of AdminRelHandler2") {
+        const std::string expected_filename = "test_admin_level_pbf_rewriter_expected.osm.pbf";
+        {
+            osmium::io::File expected_file {expected_filename};
+            AdminRelHandler2 handler {index, expected_file, osmium::io::Header{}, 10};
+            osmium::io::Reader reader {input_filename};
+            while (osmium::memory::Buffer buffer = reader.read()) {
+                osmium::apply(buffer, handler);
+            }
+            reader.close();
+        }
+        osmium::memory::Buffer expected = read_all(expected_filename);
+        osmium::memory::Buffer actual = read_all(output_filename);
+        auto exp = expected.cbegin<osmium::OSMObject>();
+        auto act = actual.cbegin<osmium::OSMObject>();
+        size_t count = 0;
+        for (; exp != expected.cend<osmium::OSMObject>() && act != actual.cend<osmium::OSMObject>(); ++exp, ++act) {
+            REQUIRE(act->type() == exp->type());
+            REQUIRE(act->id() == exp->id());
+            REQUIRE(tags_of(*act) == tags_of(*exp));
+            ++count;
+        }
+        REQUIRE(exp == expected.cend<osmium::OSMObject>());
+        REQUIRE(act == actual.cend<osmium::OSMObject>());
+        REQUIRE(count == 10);
+        std::remove(expected_filename.c_str());
+    }
+    std::remove(input_filename.c_str());
+    std::remove(output_filename.c_str());
+}
+
+TEST_CASE("Rewriter rejects files with unsupported required features") {
+    const std::string input_filename = "test_admin_level_pbf_rewriter_history.osm.pbf";
+    const std::string output_filename = "test_admin_level_pbf_rewriter_history_out.osm.pbf";
+    write_file(input_filename, make_file("HistoricalInformation"));
+    WayAdminLevelIndex index;
+    fill(index);
+    REQUIRE_THROWS_AS((AdminLevelPbfRewriter{index, 10, input_filename, output_filename, "test_generator"}),
+            const std::runtime_error&);
+    std::remove(input_filename.c_str());
+}
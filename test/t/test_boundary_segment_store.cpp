@@ -0,0 +1,65 @@
+/*
+ * test_boundary_segment_store.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include "catch.hpp"
+
+#include <boundary_segment_store.hpp>
+
+TEST_CASE("Segment store keeps the locations in the order of osmium::UndirectedSegment") {
+    BoundarySegmentStore segments;
+    segments.emplace_back(osmium::Location(2.0, 1.0), osmium::Location(1.0, 3.0), 7, 4, 9);
+
+    REQUIRE(segments.size() == 1);
+    REQUIRE(segments.first(0) == osmium::Location(1.0, 3.0));
+    REQUIRE(segments.second(0) == osmium::Location(2.0, 1.0));
+    REQUIRE(segments.y_min(0) == osmium::Location(2.0, 1.0).y());
+    REQUIRE(segments.y_max(0) == osmium::Location(1.0, 3.0).y());
+    REQUIRE(segments.way_id(0) == 7);
+    REQUIRE(segments.start_offset(0) == 4);
+    REQUIRE(segments.end_offset(0) == 9);
+    REQUIRE(segments.omitted_count(0) == 4);
+    REQUIRE(segments.at(0).omitted_count() == 4);
+}
+
+TEST_CASE("Sorting the segment store keeps the attributes of the segments together") {
+    BoundarySegmentStore segments;
+    for (int i = 0; i < 100; ++i) {
+        segments.emplace_back(osmium::Location(100.0 - i, 0.0), osmium::Location(100.0 - i, 1.0), i, i, i + 2);
+    }
+    segments.deactivate(1);
+    segments.deactivate(70);
+    segments.sort();
+
+    REQUIRE(segments.size() == 100);
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const osmium::object_id_type way_id = static_cast<osmium::object_id_type>(99 - i);
+        REQUIRE(segments.first(i) == osmium::Location(1.0 + i, 0.0));
+        REQUIRE(segments.way_id(i) == way_id);
+        REQUIRE(segments.start_offset(i) == static_cast<size_t>(way_id));
+        REQUIRE(segments.active(i) == (way_id != 1 && way_id != 70));
+    }
+}
+
+TEST_CASE("Appending a segment store keeps the deactivated segments") {
+    BoundarySegmentStore segments1;
+    BoundarySegmentStore segments2;
+    for (int i = 0; i < 70; ++i) {
+        segments1.emplace_back(osmium::Location(i * 0.1, 0.0), osmium::Location(i * 0.1, 1.0), 1, i, i + 1);
+        segments2.emplace_back(osmium::Location(i * 0.1, 2.0), osmium::Location(i * 0.1, 3.0), 2, i, i + 1);
+    }
+    segments1.deactivate(3);
+    segments2.deactivate(0);
+    segments2.deactivate(69);
+    segments1.append(segments2);
+    segments1.emplace_back(osmium::Location(0.0, 5.0), osmium::Location(1.0, 5.0), 3, 0, 1);
+
+    REQUIRE(segments1.size() == 141);
+    REQUIRE(segments1.way_id(70) == 2);
+    REQUIRE(segments1.first(70) == osmium::Location(0.0, 2.0));
+    for (size_t i = 0; i < segments1.size(); ++i) {
+        REQUIRE(segments1.active(i) == (i != 3 && i != 70 && i != 139));
+    }
+}
@@ -6,6 +6,9 @@
  */
 
 #include "catch.hpp"
+#include <array>
+#include <cmath>
+#include <vector>
 #include <distance_sphere_plain.hpp>
 
 /**
@@ -97,4 +100,27 @@ TEST_CASE("Distances between two points") {
 //    }
 }
 
+TEST_CASE("Unit vector distance is close to the distance calculated using bearings") {
+    DistanceSpherePlain dist_object;
+    // (start, end, point)
+    const std::vector<std::array<osmium::Location, 3>> cases = {
+        {{osmium::Location(0.0, 0.0), osmium::Location(0.3, 0.0), osmium::Location(0.15, 0.1)}},
+        {{osmium::Location(-95.1534, 49.3845), osmium::Location(-95.1531, 49.0), osmium::Location(-95.1517, 49.2274)}},
+        {{osmium::Location(13.4, 52.5), osmium::Location(13.41, 52.51), osmium::Location(13.402, 52.508)}},
+        {{osmium::Location(-179.9, 65.2), osmium::Location(179.8, 65.0), osmium::Location(179.95, 65.3)}},
+        {{osmium::Location(10.0, -80.0), osmium::Location(18.0, -79.0), osmium::Location(14.0, -79.0)}},
+        {{osmium::Location(0.0, 0.0), osmium::Location(8.0, 1.0), osmium::Location(2.0, -2.0)}}
+    };
+    for (const std::array<osmium::Location, 3>& c : cases) {
+        const double expected = dist_object.distance_from_line_bearings(c[0], c[1], c[2]);
+        REQUIRE(std::abs(dist_object.distance_from_line_sphere(c[0], c[1], c[2]) - expected) < 0.01);
+    }
+}
 
+TEST_CASE("Distance from a line whose start and end are equal") {
+    DistanceSpherePlain dist_object;
+    const osmium::Location start (7.5, 47.5);
+    const osmium::Location point (7.51, 47.52);
+    const GreatCircle circle {Vector3D::unit_vector(start), Vector3D::unit_vector(start)};
+    REQUIRE(circle.distance(Vector3D::unit_vector(point)) == Approx(osmium::geom::haversine::distance(start, point)));
+}
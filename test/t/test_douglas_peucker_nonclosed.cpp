@@ -135,3 +135,21 @@ TEST_CASE("Line with four nodes") {
         REQUIRE(test_utils::count_non_nullptr_elements(kept_node_refs) == 4);
     }
 }
+
+TEST_CASE("Long zigzag line") {
+    osmium::memory::Buffer buffer (1024*1024, osmium::memory::Buffer::auto_grow::yes);
+    // build way
+    std::vector<osmium::object_id_type> node_refs;
+    std::vector<osmium::Location> node_locations;
+    for (int i = 0; i < 50000; ++i) {
+        node_refs.push_back(i + 1);
+        node_locations.emplace_back(i * 0.001, 50.0 + (i % 2) * 0.01);
+    }
+    test_douglas_peucker::build_way(buffer, node_refs, node_locations);
+
+    const osmium::Way& way = static_cast<const osmium::Way&>(*(buffer.cbegin()));
+    std::vector<const osmium::NodeRef*> kept_node_refs {way.nodes().size(), nullptr};
+    run_simplification(way, kept_node_refs);
+
+    REQUIRE(test_utils::count_non_nullptr_elements(kept_node_refs) == kept_node_refs.size());
+}
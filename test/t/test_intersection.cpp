@@ -14,7 +14,7 @@
 TEST_CASE("Intersection is start point of one segment") {
     ErrorsMap errors;
     KeepNodesMap nodes_to_be_kept;
-    std::vector<BoundarySegment> segments;
+    BoundarySegmentStore segments;
     std::unordered_set<osmium::object_id_type> treat_as_rings_way;
     osmium::util::VerboseOutput vout(true);
 
@@ -33,7 +33,7 @@ TEST_CASE("Intersection is start point of one segment") {
 TEST_CASE("One line is vertical") {
     ErrorsMap errors;
     KeepNodesMap nodes_to_be_kept;
-    std::vector<BoundarySegment> segments;
+    BoundarySegmentStore segments;
     std::unordered_set<osmium::object_id_type> treat_as_rings_way;
     osmium::util::VerboseOutput vout(true);
 
@@ -52,7 +52,7 @@ TEST_CASE("One line is vertical") {
 TEST_CASE("Simple test") {
     ErrorsMap errors;
     KeepNodesMap nodes_to_be_kept;
-    std::vector<BoundarySegment> segments;
+    BoundarySegmentStore segments;
     std::unordered_set<osmium::object_id_type> treat_as_rings_way;
     osmium::util::VerboseOutput vout(true);
 
@@ -71,7 +71,7 @@ TEST_CASE("Simple test") {
 TEST_CASE("parallel lines not intersecting") {
     ErrorsMap errors;
     KeepNodesMap nodes_to_be_kept;
-    std::vector<BoundarySegment> segments;
+    BoundarySegmentStore segments;
     std::unordered_set<osmium::object_id_type> treat_as_rings_way;
     osmium::util::VerboseOutput vout(true);
 
@@ -90,7 +90,7 @@ TEST_CASE("parallel lines not intersecting") {
 TEST_CASE("parallel lines overlapping") {
     ErrorsMap errors;
     KeepNodesMap nodes_to_be_kept;
-    std::vector<BoundarySegment> segments;
+    BoundarySegmentStore segments;
     std::unordered_set<osmium::object_id_type> treat_as_rings_way;
     osmium::util::VerboseOutput vout(true);
 
@@ -109,7 +109,7 @@ TEST_CASE("parallel lines overlapping") {
 TEST_CASE("1234parallel lines overlapping") {
     ErrorsMap errors;
     KeepNodesMap nodes_to_be_kept;
-    std::vector<BoundarySegment> segments;
+    BoundarySegmentStore segments;
     std::unordered_set<osmium::object_id_type> treat_as_rings_way;
     osmium::util::VerboseOutput vout(true);
 
@@ -124,3 +124,166 @@ TEST_CASE("1234parallel lines overlapping") {
 
     REQUIRE(interm_simplifier.intersection(segments.at(0), segments.at(1)) == osmium::Location());
 }
+
+TEST_CASE("Location of crossing segments") {
+    ErrorsMap errors;
+    KeepNodesMap nodes_to_be_kept;
+    BoundarySegmentStore segments;
+    osmium::util::VerboseOutput vout(false);
+
+    segments.emplace_back(osmium::Location(1.0, 1.0), osmium::Location(3.0, 3.0), 1, 0, 2);
+    segments.emplace_back(osmium::Location(1.0, 3.0), osmium::Location(3.0, 1.0), 2, 0, 2);
+    // end of the third segment on the first segment
+    segments.emplace_back(osmium::Location(2.5, 2.5), osmium::Location(2.5, 4.0), 3, 0, 2);
+    // on the same line as the first segment but not overlapping
+    segments.emplace_back(osmium::Location(3.5, 3.5), osmium::Location(4.0, 4.0), 4, 0, 2);
+
+    IntermediateSimplifier interm_simplifier (100, errors, segments, nodes_to_be_kept, vout);
+
+    REQUIRE(interm_simplifier.intersection(segments.at(0), segments.at(1)) == osmium::Location(2.0, 2.0));
+    REQUIRE(interm_simplifier.intersection(segments.at(0), segments.at(2)) == osmium::Location(2.5, 2.5));
+    REQUIRE(interm_simplifier.intersection(segments.at(0), segments.at(3)) == osmium::Location());
+}
+
+TEST_CASE("Intersection of segments spanning the whole world") {
+    ErrorsMap errors;
+    KeepNodesMap nodes_to_be_kept;
+    BoundarySegmentStore segments;
+    osmium::util::VerboseOutput vout(false);
+
+    segments.emplace_back(osmium::Location(-180.0, -90.0), osmium::Location(180.0, 90.0), 1, 0, 2);
+    segments.emplace_back(osmium::Location(-180.0, 90.0), osmium::Location(180.0, -90.0), 2, 0, 2);
+    segments.emplace_back(osmium::Location(-180.0 + 1e-7, -90.0), osmium::Location(180.0, 90.0 - 1e-7), 3, 0, 2);
+
+    IntermediateSimplifier interm_simplifier (100, errors, segments, nodes_to_be_kept, vout);
+
+    REQUIRE(interm_simplifier.intersection(segments.at(0), segments.at(1)) == osmium::Location(0.0, 0.0));
+    REQUIRE(interm_simplifier.intersection(segments.at(0), segments.at(2)) == osmium::Location());
+}
+
+TEST_CASE("Long east-west segment crossed by short segments") {
+    ErrorsMap errors;
+    KeepNodesMap nodes_to_be_kept;
+    BoundarySegmentStore segments;
+    osmium::util::VerboseOutput vout(false);
+
+    segments.emplace_back(osmium::Location(0.0, 1.0), osmium::Location(10.0, 1.0), 1, 0, 5);
+    segments.emplace_back(osmium::Location(2.0, 0.5), osmium::Location(2.0, 1.5), 2, 0, 3);
+    segments.emplace_back(osmium::Location(8.0, 1.5), osmium::Location(8.5, 0.5), 3, 10, 12);
+    // far away from the long segment
+    segments.emplace_back(osmium::Location(5.0, 3.0), osmium::Location(5.5, 4.0), 4, 0, 4);
+
+    IntermediateSimplifier interm_simplifier (100, errors, segments, nodes_to_be_kept, vout);
+
+    REQUIRE(interm_simplifier.recheck_intersections());
+    REQUIRE(errors.count(1) == 1);
+    REQUIRE(errors.count(2) == 1);
+    REQUIRE(errors.count(3) == 1);
+    REQUIRE(errors.count(4) == 0);
+}
+
+TEST_CASE("Segments with overlapping bounding boxes but without intersection") {
+    ErrorsMap errors;
+    KeepNodesMap nodes_to_be_kept;
+    BoundarySegmentStore segments;
+    osmium::util::VerboseOutput vout(false);
+
+    segments.emplace_back(osmium::Location(0.0, 0.0), osmium::Location(1.0, 1.0), 1, 0, 5);
+    segments.emplace_back(osmium::Location(0.5, 0.0), osmium::Location(1.0, 0.4), 2, 0, 3);
+    segments.emplace_back(osmium::Location(1.0, 1.0), osmium::Location(2.0, 0.0), 1, 5, 9);
+
+    IntermediateSimplifier interm_simplifier (100, errors, segments, nodes_to_be_kept, vout);
+
+    REQUIRE_FALSE(interm_simplifier.recheck_intersections());
+    REQUIRE(errors.empty());
+}
+
+TEST_CASE("Omitted nodes of a reversed segment") {
+    BoundarySegment forward (osmium::Location(1.0, 1.0), osmium::Location(2.0, 2.0), 1, 2, 6);
+    BoundarySegment reverse (osmium::Location(2.0, 2.0), osmium::Location(1.0, 1.0), 1, 2, 6);
+    REQUIRE_FALSE(forward.get_reverse());
+    REQUIRE(reverse.get_reverse());
+    REQUIRE(forward.omitted_count() == 3);
+    REQUIRE(reverse.omitted_count() == 3);
+    BoundarySegment reverse_unsimplified (osmium::Location(2.0, 2.0), osmium::Location(1.0, 1.0), 1, 6, 7);
+    REQUIRE(reverse_unsimplified.omitted_count() == 0);
+}
+
+TEST_CASE("Crossing reversed segment without omitted nodes is not reported") {
+    ErrorsMap errors;
+    KeepNodesMap nodes_to_be_kept;
+    BoundarySegmentStore segments;
+    osmium::util::VerboseOutput vout(false);
+
+    segments.emplace_back(osmium::Location(1.0, 0.0), osmium::Location(0.0, 1.0), 1, 4, 5);
+    segments.emplace_back(osmium::Location(0.0, 0.0), osmium::Location(1.0, 1.0), 2, 0, 1);
+
+    IntermediateSimplifier interm_simplifier (100, errors, segments, nodes_to_be_kept, vout);
+
+    REQUIRE(interm_simplifier.recheck_intersections());
+    REQUIRE(errors.empty());
+}
+
+TEST_CASE("Parallel check reports the same segments as the single-threaded check") {
+    osmium::util::VerboseOutput vout(false);
+    BoundarySegmentStore segments;
+    // a long zigzag line along the equator and short lines crossing it
+    for (size_t i = 0; i < 3000; ++i) {
+        const double x = i * 0.01;
+        segments.emplace_back(osmium::Location(x, 0.0), osmium::Location(x + 0.01, (i % 2) ? 0.004 : -0.004), 1, i * 2, i * 2 + 2);
+        segments.emplace_back(osmium::Location(x + 0.003, -0.01), osmium::Location(x + 0.004, 0.01), 10 + i, 0, (i % 3) + 1);
+    }
+    // a segment crossing many strips
+    segments.emplace_back(osmium::Location(0.005, 0.002), osmium::Location(29.0, 0.0021), 2, 0, 10);
+    BoundarySegmentStore segments2 {segments};
+
+    ErrorsMap errors1;
+    KeepNodesMap nodes_to_be_kept1;
+    IntermediateSimplifier interm_simplifier1 (100, errors1, segments, nodes_to_be_kept1, vout, 1);
+    REQUIRE(interm_simplifier1.recheck_intersections());
+
+    ErrorsMap errors2;
+    KeepNodesMap nodes_to_be_kept2;
+    IntermediateSimplifier interm_simplifier2 (100, errors2, segments2, nodes_to_be_kept2, vout, 2);
+    REQUIRE(interm_simplifier2.recheck_intersections());
+
+    REQUIRE(errors1.size() == errors2.size());
+    REQUIRE(errors1.count(2) == 1);
+    REQUIRE(errors2.count(2) == 1);
+    size_t differences = 0;
+    for (const auto& e : errors1) {
+        if (errors2.count(e.first) != errors1.count(e.first)) {
+            ++differences;
+        }
+    }
+    REQUIRE(differences == 0);
+}
+
+TEST_CASE("Later checks only look at new segments") {
+    ErrorsMap errors;
+    KeepNodesMap nodes_to_be_kept;
+    BoundarySegmentStore segments;
+    osmium::util::VerboseOutput vout(false);
+
+    segments.emplace_back(osmium::Location(0.0, 0.0), osmium::Location(2.0, 2.0), 1, 0, 4);
+    segments.emplace_back(osmium::Location(0.0, 2.0), osmium::Location(2.0, 0.0), 2, 0, 4);
+    segments.emplace_back(osmium::Location(5.0, 0.0), osmium::Location(6.0, 0.0), 3, 0, 4);
+
+    IntermediateSimplifier interm_simplifier (100, errors, segments, nodes_to_be_kept, vout);
+    REQUIRE(interm_simplifier.recheck_intersections());
+    REQUIRE(errors.size() == 2);
+
+    // new segments, not intersecting anything
+    segments.emplace_back(osmium::Location(10.0, 10.0), osmium::Location(11.0, 11.0), 1, 0, 2);
+    segments.emplace_back(osmium::Location(11.0, 11.0), osmium::Location(12.0, 10.0), 1, 2, 4);
+    segments.emplace_back(osmium::Location(20.0, 20.0), osmium::Location(21.0, 21.0), 2, 0, 4);
+    REQUIRE_FALSE(interm_simplifier.recheck_intersections());
+    REQUIRE(errors.size() == 2);
+
+    // a new segment crossing a segment which has been checked before
+    segments.emplace_back(osmium::Location(5.5, -1.0), osmium::Location(5.5, 1.0), 4, 0, 3);
+    REQUIRE(interm_simplifier.recheck_intersections());
+    REQUIRE(errors.size() == 4);
+    REQUIRE(errors.count(3) == 1);
+    REQUIRE(errors.count(4) == 1);
+}
@@ -0,0 +1,82 @@
+/*
+ * test_kept_nodes_index.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include "catch.hpp"
+
+#include <kept_nodes_index.hpp>
+
+TEST_CASE("Kept nodes index returns the offsets of the kept nodes") {
+    KeptNodesIndex index;
+    index.add_way(3, {true, false, false, true});
+    index.add_way(8, {true, true, false, true, true});
+    index.add_way(12, {true, true});
+    REQUIRE(index.size() == 3);
+
+    const uint32_t* begin;
+    const uint32_t* end;
+    size_t position = 0;
+    SECTION("Lookup in the order the ways have been added") {
+        REQUIRE(index.find(3, begin, end, position));
+        REQUIRE(std::vector<uint32_t>(begin, end) == std::vector<uint32_t>({0, 3}));
+        REQUIRE(index.find(8, begin, end, position));
+        REQUIRE(std::vector<uint32_t>(begin, end) == std::vector<uint32_t>({0, 1, 3, 4}));
+        REQUIRE(index.find(12, begin, end, position));
+        REQUIRE(std::vector<uint32_t>(begin, end) == std::vector<uint32_t>({0, 1}));
+    }
+
+    SECTION("Lookup in a different order") {
+        REQUIRE(index.find(12, begin, end, position));
+        REQUIRE(std::vector<uint32_t>(begin, end) == std::vector<uint32_t>({0, 1}));
+        REQUIRE(index.find(8, begin, end, position));
+        REQUIRE(std::vector<uint32_t>(begin, end) == std::vector<uint32_t>({0, 1, 3, 4}));
+        REQUIRE_FALSE(index.find(9, begin, end, position));
+        REQUIRE_FALSE(index.find(13, begin, end, position));
+    }
+}
+
+TEST_CASE("Appending a kept nodes index") {
+    KeptNodesIndex index1;
+    index1.add_way(3, {true, false, true});
+    KeptNodesIndex index2;
+    index2.add_way(5, {true, true, false, true});
+    index2.add_way(6, {true, false, false, false, true});
+    index1.append(index2);
+    REQUIRE(index1.size() == 3);
+
+    const uint32_t* begin;
+    const uint32_t* end;
+    size_t position = 0;
+    REQUIRE(index1.find(3, begin, end, position));
+    REQUIRE(std::vector<uint32_t>(begin, end) == std::vector<uint32_t>({0, 2}));
+    REQUIRE(index1.find(5, begin, end, position));
+    REQUIRE(std::vector<uint32_t>(begin, end) == std::vector<uint32_t>({0, 1, 3}));
+    REQUIRE(index1.find(6, begin, end, position));
+    REQUIRE(std::vector<uint32_t>(begin, end) == std::vector<uint32_t>({0, 4}));
+}
+
+TEST_CASE("Sorting a kept nodes index") {
+    KeptNodesIndex index;
+    index.add_way(8, {true, true, false, true, true});
+    index.add_way(12, {true, true});
+    index.add_way(3, {true, false, false, true});
+    index.add_way(5, {true, false, true});
+    index.sort();
+    REQUIRE(index.size() == 4);
+
+    const uint32_t* begin;
+    const uint32_t* end;
+    size_t position = 0;
+    REQUIRE(index.find(3, begin, end, position));
+    REQUIRE(std::vector<uint32_t>(begin, end) == std::vector<uint32_t>({0, 3}));
+    REQUIRE(position == 1);
+    REQUIRE(index.find(5, begin, end, position));
+    REQUIRE(std::vector<uint32_t>(begin, end) == std::vector<uint32_t>({0, 2}));
+    REQUIRE(index.find(12, begin, end, position));
+    REQUIRE(std::vector<uint32_t>(begin, end) == std::vector<uint32_t>({0, 1}));
+    REQUIRE(index.find(8, begin, end, position));
+    REQUIRE(std::vector<uint32_t>(begin, end) == std::vector<uint32_t>({0, 1, 3, 4}));
+    REQUIRE_FALSE(index.find(4, begin, end, position));
+}
@@ -0,0 +1,58 @@
+/*
+ * test_merge_sorted_runs.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include "catch.hpp"
+
+#include <functional>
+#include <string>
+#include <merge_sorted_runs.hpp>
+
+using iterator = std::vector<int>::const_iterator;
+
+static std::vector<int> merge(const std::vector<std::vector<int>>& inputs) {
+    std::vector<std::pair<iterator, iterator>> runs;
+    for (const std::vector<int>& input : inputs) {
+        runs.emplace_back(input.cbegin(), input.cend());
+    }
+    std::vector<int> result;
+    merge_sorted_runs(runs, std::less<int>(), [](const int value) {
+        return value;
+    }, [&result](const int value) {
+        result.push_back(value);
+    });
+    return result;
+}
+
+TEST_CASE("Merging sorted runs") {
+    REQUIRE(merge({{1, 4, 7}, {2, 5, 8}, {3, 6, 9}}) == std::vector<int>({1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+TEST_CASE("Merging sorted runs drops duplicates within and across runs") {
+    REQUIRE(merge({{1, 1, 3, 5}, {1, 3, 4}, {5}}) == std::vector<int>({1, 3, 4, 5}));
+}
+
+TEST_CASE("Merging empty runs") {
+    REQUIRE(merge({{}, {2, 3}, {}}) == std::vector<int>({2, 3}));
+    REQUIRE(merge({{}}).empty());
+    REQUIRE(merge({}).empty());
+}
+
+TEST_CASE("Merging sorted runs uses the key to detect duplicates") {
+    const std::vector<std::pair<int, char>> run1 {{1, 'a'}, {2, 'a'}};
+    const std::vector<std::pair<int, char>> run2 {{1, 'b'}, {3, 'b'}};
+    using pair_iterator = std::vector<std::pair<int, char>>::const_iterator;
+    std::vector<std::pair<pair_iterator, pair_iterator>> runs {{run1.cbegin(), run1.cend()},
+        {run2.cbegin(), run2.cend()}};
+    std::string result;
+    merge_sorted_runs(runs, [](const std::pair<int, char>& lhs, const std::pair<int, char>& rhs) {
+        return lhs < rhs;
+    }, [](const std::pair<int, char>& element) {
+        return element.first;
+    }, [&result](const std::pair<int, char>& element) {
+        result.push_back(element.second);
+    });
+    REQUIRE(result == "aab");
+}
@@ -0,0 +1,74 @@
+/*
+ * test_node_id_set.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include "catch.hpp"
+
+#include <atomic>
+#include <future>
+#include <vector>
+#include <node_id_set.hpp>
+
+TEST_CASE("Node ID set reports the first insertion only") {
+    NodeIdSet set;
+    set.reserve(1000000);
+    REQUIRE(set.insert(5));
+    REQUIRE(set.insert(999999));
+    REQUIRE_FALSE(set.insert(5));
+    REQUIRE(set.contains(5));
+    REQUIRE(set.contains(999999));
+    REQUIRE_FALSE(set.contains(6));
+    REQUIRE_FALSE(set.contains(2000000));
+}
+
+TEST_CASE("Node ID set allocates only chunks containing nodes") {
+    NodeIdSet set;
+    set.reserve(100 * NodeIdSet::CHUNK_BITS);
+    const size_t empty_size = set.used_memory();
+    set.insert(3);
+    set.insert(4);
+    const size_t one_chunk = set.used_memory();
+    REQUIRE(one_chunk > empty_size);
+    set.insert(100 * NodeIdSet::CHUNK_BITS);
+    REQUIRE(set.used_memory() - one_chunk == one_chunk - empty_size);
+}
+
+TEST_CASE("Node ID set keeps its content when reserving more IDs") {
+    NodeIdSet set;
+    set.reserve(10);
+    set.insert(10);
+    set.reserve(10 * NodeIdSet::CHUNK_BITS);
+    REQUIRE(set.contains(10));
+    REQUIRE_FALSE(set.insert(10));
+    REQUIRE(set.insert(10 * NodeIdSet::CHUNK_BITS));
+}
+
+TEST_CASE("Negative node IDs are always reported as new") {
+    NodeIdSet set;
+    REQUIRE(set.insert(-3));
+    REQUIRE(set.insert(-3));
+    REQUIRE_FALSE(set.contains(-3));
+}
+
+TEST_CASE("Node ID set can be filled by multiple threads") {
+    NodeIdSet set;
+    const osmium::object_id_type max_id = 4 * NodeIdSet::CHUNK_BITS;
+    set.reserve(max_id);
+    std::atomic<size_t> inserted {0};
+    std::vector<std::future<void>> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.push_back(std::async(std::launch::async, [&set, &inserted, max_id]() {
+            for (osmium::object_id_type id = 0; id < max_id; id += 3) {
+                if (set.insert(id)) {
+                    ++inserted;
+                }
+            }
+        }));
+    }
+    for (std::future<void>& w : workers) {
+        w.get();
+    }
+    REQUIRE(inserted == static_cast<size_t>((max_id + 2) / 3));
+}
@@ -0,0 +1,143 @@
+/*
+ * test_output_spool.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+#include <dirent.h>
+#include <unistd.h>
+#include <osmium/builder/osm_object_builder.hpp>
+#include <osmium/io/any_input.hpp>
+#include <osmium/io/any_output.hpp>
+#include <osmium/io/reader.hpp>
+#include <osmium/io/writer.hpp>
+#include <osmium/osm/node.hpp>
+#include <osmium/osm/way.hpp>
+#include <output_spool.hpp>
+
+using object_list = std::vector<std::pair<osmium::item_type, osmium::object_id_type>>;
+
+static void add_node(osmium::memory::Buffer& buffer, const osmium::object_id_type id) {
+    {
+        osmium::builder::NodeBuilder builder(buffer);
+        osmium::Node& node = static_cast<osmium::Node&>(builder.object());
+        node.set_id(id);
+        node.set_visible(true);
+        builder.set_user("");
+        node.set_location(osmium::Location(id * 0.01, 1.0));
+    }
+    buffer.commit();
+}
+
+/**
+ * Add a way and its nodes. Consecutive ways share two nodes.
+ */
+static void add_way(osmium::memory::Buffer& buffer, const osmium::object_id_type id) {
+    const osmium::object_id_type first_node = id * 2;
+    {
+        osmium::builder::WayBuilder builder(buffer);
+        osmium::Way& way = static_cast<osmium::Way&>(builder.object());
+        way.set_id(id);
+        way.set_visible(true);
+        builder.set_user("");
+        osmium::builder::WayNodeListBuilder wnl_builder{buffer, &builder};
+        for (osmium::object_id_type ref = first_node; ref < first_node + 4; ++ref) {
+            wnl_builder.add_node_ref(osmium::NodeRef(ref, osmium::Location(ref * 0.01, 1.0)));
+        }
+    }
+    buffer.commit();
+    for (osmium::object_id_type ref = first_node; ref < first_node + 4; ++ref) {
+        add_node(buffer, ref);
+    }
+}
+
+/**
+ * Count the files in a directory except of . and ..
+ */
+static size_t file_count(const std::string& directory) {
+    size_t result = 0;
+    DIR* dir = opendir(directory.c_str());
+    REQUIRE(dir != nullptr);
+    while (dirent* entry = readdir(dir)) {
+        const std::string name = entry->d_name;
+        if (name != "." && name != "..") {
+            ++result;
+        }
+    }
+    closedir(dir);
+    return result;
+}
+
+/**
+ * Add 20 ways in two rounds (odd IDs first) with one buffer per way to a spool, write it and
+ * return the type and ID of the objects of the output file.
+ */
+static object_list write_with_budget(const size_t memory_budget, const size_t expected_runs) {
+    std::string tmp_directory = "test_output_spool_XXXXXX";
+    REQUIRE(mkdtemp(&tmp_directory[0]) != nullptr);
+    const std::string filename = "test_output_spool.osm.pbf";
+    {
+        OutputSpool spool {tmp_directory, memory_budget};
+        for (osmium::object_id_type id = 1; id <= 20; id += 2) {
+            osmium::memory::Buffer buffer {1024, osmium::memory::Buffer::auto_grow::yes};
+            add_way(buffer, id);
+            spool.add(buffer);
+        }
+        for (osmium::object_id_type id = 2; id <= 20; id += 2) {
+            osmium::memory::Buffer buffer {1024, osmium::memory::Buffer::auto_grow::yes};
+            add_way(buffer, id);
+            spool.add(buffer);
+        }
+        REQUIRE(spool.run_count() == expected_runs);
+        osmium::io::File file {filename};
+        file.set("locations_on_ways", true);
+        osmium::io::Writer writer {file, osmium::io::Header{}, osmium::io::overwrite::allow};
+        spool.write(writer);
+        writer.close();
+        if (expected_runs > 0) {
+            REQUIRE(file_count(tmp_directory) == spool.run_count());
+        }
+    }
+    // The spool removes its temporary files.
+    REQUIRE(file_count(tmp_directory) == 0);
+    REQUIRE(rmdir(tmp_directory.c_str()) == 0);
+
+    object_list result;
+    osmium::io::Reader reader {filename};
+    while (osmium::memory::Buffer buffer = reader.read()) {
+        for (auto it = buffer.cbegin<osmium::OSMObject>(); it != buffer.cend<osmium::OSMObject>(); ++it) {
+            result.emplace_back(it->type(), it->id());
+        }
+    }
+    reader.close();
+    std::remove(filename.c_str());
+    return result;
+}
+
+static object_list expected_objects() {
+    object_list result;
+    // node IDs 2 to 43 without duplicates
+    for (osmium::object_id_type id = 2; id <= 43; ++id) {
+        result.emplace_back(osmium::item_type::node, id);
+    }
+    for (osmium::object_id_type id = 1; id <= 20; ++id) {
+        result.emplace_back(osmium::item_type::way, id);
+    }
+    return result;
+}
+
+TEST_CASE("Output spool merges several runs") {
+    // Every buffer exceeds the budget and is spilled to its own run.
+    REQUIRE(write_with_budget(1, 20) == expected_objects());
+}
+
+TEST_CASE("Output spool keeps everything in memory if the budget is large enough") {
+    REQUIRE(write_with_budget(1024 * 1024 * 1024, 0) == expected_objects());
+}
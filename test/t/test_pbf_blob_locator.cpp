@@ -0,0 +1,140 @@
+/*
+ * test_pbf_blob_locator.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <protozero/pbf_writer.hpp>
+#include <zlib.h>
+#include <pbf_blob_locator.hpp>
+
+/**
+ * Build a blob with its header. The content is zlib compressed if requested.
+ */
+static std::string make_blob(const std::string& type, const std::string& content, const bool compress) {
+    std::string blob;
+    protozero::pbf_writer blob_writer {blob};
+    if (compress) {
+        uLongf compressed_size = compressBound(static_cast<uLong>(content.size()));
+        std::string compressed (compressed_size, '\0');
+        compress2(reinterpret_cast<Bytef*>(&compressed[0]), &compressed_size,
+                reinterpret_cast<const Bytef*>(content.data()), static_cast<uLong>(content.size()), Z_DEFAULT_COMPRESSION);
+        compressed.resize(compressed_size);
+        blob_writer.add_int32(2, static_cast<int32_t>(content.size()));
+        blob_writer.add_bytes(3, compressed);
+    } else {
+        blob_writer.add_bytes(1, content);
+    }
+    std::string header;
+    protozero::pbf_writer header_writer {header};
+    header_writer.add_string(1, type);
+    header_writer.add_int32(3, static_cast<int32_t>(blob.size()));
+    std::string result;
+    const uint32_t header_size = static_cast<uint32_t>(header.size());
+    result.push_back(static_cast<char>((header_size >> 24) & 0xff));
+    result.push_back(static_cast<char>((header_size >> 16) & 0xff));
+    result.push_back(static_cast<char>((header_size >> 8) & 0xff));
+    result.push_back(static_cast<char>(header_size & 0xff));
+    return result + header + blob;
+}
+
+static std::string make_header_blob(const bool sorted) {
+    std::string block;
+    protozero::pbf_writer writer {block};
+    writer.add_string(4, "OsmSchema-V0.6");
+    writer.add_string(4, "DenseNodes");
+    if (sorted) {
+        writer.add_string(5, "Sort.Type_then_ID");
+    }
+    return make_blob("OSMHeader", block, false);
+}
+
+/**
+ * Build a data blob with one primitive group. The group contains a single empty object of the
+ * given field (2 dense nodes, 3 ways, 4 relations).
+ */
+static std::string make_data_blob(const protozero::pbf_tag_type field, const bool compress) {
+    std::string object;
+    protozero::pbf_writer object_writer {object};
+    object_writer.add_int64(1, 1);
+    std::string group;
+    protozero::pbf_writer group_writer {group};
+    group_writer.add_message(field, object);
+    std::string block;
+    protozero::pbf_writer writer {block};
+    writer.add_message(1, std::string{});
+    writer.add_message(2, group);
+    return make_blob("OSMData", block, compress);
+}
+
+static void write_file(const std::string& filename, const std::string& content) {
+    std::ofstream file {filename, std::ios::binary};
+    file << content;
+}
+
+TEST_CASE("Blob locator finds the first relation blob") {
+    const std::string filename = "test_pbf_blob_locator.osm.pbf";
+    std::string content = make_header_blob(true);
+    for (int i = 0; i < 5; ++i) {
+        content += make_data_blob(2, i % 2 == 0);
+    }
+    for (int i = 0; i < 3; ++i) {
+        content += make_data_blob(3, i % 2 == 0);
+    }
+    for (int i = 0; i < 2; ++i) {
+        content += make_data_blob(4, i % 2 == 0);
+    }
+    write_file(filename, content);
+    PbfBlobLocator locator {filename};
+    REQUIRE(locator.sorted());
+    REQUIRE(locator.file_size() == content.size());
+    REQUIRE(locator.data_blobs().size() == 10);
+    REQUIRE(locator.first_blob_with(osmium::item_type::node) == 0);
+    REQUIRE(locator.first_blob_with(osmium::item_type::way) == 4);
+    REQUIRE(locator.first_blob_with(osmium::item_type::relation) == 7);
+
+    SECTION("file image contains the header blob and the selected data blobs") {
+        const std::string image = locator.file_image(8, 10);
+        const std::string header = content.substr(0, locator.header_blob().m_size);
+        const std::string data = content.substr(locator.data_blobs()[8].m_offset);
+        REQUIRE(image == header + data);
+    }
+
+    SECTION("raw blobs are returned without the header blob") {
+        const std::vector<PbfBlobLocator::Blob>& blobs = locator.data_blobs();
+        const std::string raw = locator.raw_blobs(2, 4);
+        REQUIRE(raw == content.substr(blobs[2].m_offset, blobs[2].m_size + blobs[3].m_size));
+        REQUIRE(locator.raw_blobs(3, 3).empty());
+    }
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Blob locator detects unsorted files") {
+    const std::string filename = "test_pbf_blob_locator_unsorted.osm.pbf";
+    write_file(filename, make_header_blob(false) + make_data_blob(4, false));
+    PbfBlobLocator locator {filename};
+    REQUIRE_FALSE(locator.sorted());
+    REQUIRE(locator.data_blobs().size() == 1);
+    REQUIRE(locator.header_block().find("DenseNodes") != std::string::npos);
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Blob locator returns the first blob if there are no relations") {
+    const std::string filename = "test_pbf_blob_locator_no_relations.osm.pbf";
+    write_file(filename, make_header_blob(true) + make_data_blob(2, true) + make_data_blob(3, true));
+    PbfBlobLocator locator {filename};
+    REQUIRE(locator.first_blob_with(osmium::item_type::relation) == 1);
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Blob locator rejects truncated files") {
+    const std::string filename = "test_pbf_blob_locator_truncated.osm.pbf";
+    const std::string content = make_header_blob(true) + make_data_blob(2, false);
+    write_file(filename, content.substr(0, content.size() - 3));
+    REQUIRE_THROWS_AS(PbfBlobLocator{filename}, const std::runtime_error&);
+    std::remove(filename.c_str());
+}
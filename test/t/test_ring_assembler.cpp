@@ -0,0 +1,73 @@
+/*
+ * test_ring_assembler.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <ring_assembler.hpp>
+
+static std::vector<osmium::object_id_type> small_ring_ways(const RingAssembler& assembler) {
+    std::vector<osmium::object_id_type> result;
+    assembler.for_each_way_of_small_rings([&result](const osmium::object_id_type way_id) {
+        result.push_back(way_id);
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+TEST_CASE("Closed way is a small ring") {
+    RingAssembler assembler;
+    assembler.clear(2);
+    assembler.add_way(1, 10, 10);
+    assembler.add_way(2, 20, 21);
+    REQUIRE(assembler.closed_ring_count() == 1);
+    REQUIRE(small_ring_ways(assembler) == std::vector<osmium::object_id_type>({1}));
+}
+
+TEST_CASE("Two ways form a small ring in any direction") {
+    RingAssembler assembler;
+    assembler.clear(4);
+    assembler.add_way(1, 10, 11);
+    assembler.add_way(2, 10, 11);
+    assembler.add_way(3, 20, 21);
+    assembler.add_way(4, 20, 21);
+    assembler.add_way(5, 30, 31);
+    REQUIRE(assembler.closed_ring_count() == 2);
+    REQUIRE(small_ring_ways(assembler) == std::vector<osmium::object_id_type>({1, 2, 3, 4}));
+}
+
+TEST_CASE("Rings with more than two ways are not small") {
+    RingAssembler assembler;
+    assembler.clear(3);
+    assembler.add_way(1, 10, 11);
+    assembler.add_way(2, 11, 12);
+    assembler.add_way(3, 12, 10);
+    REQUIRE(assembler.closed_ring_count() == 1);
+    REQUIRE(small_ring_ways(assembler).empty());
+}
+
+TEST_CASE("Open rings are merged if a later way connects them") {
+    RingAssembler assembler;
+    assembler.clear(4);
+    // Ways 1 and 2 do not touch each other. Way 3 connects them, way 4 closes the ring.
+    assembler.add_way(1, 10, 11);
+    assembler.add_way(2, 12, 13);
+    assembler.add_way(3, 11, 12);
+    assembler.add_way(4, 13, 10);
+    REQUIRE(assembler.closed_ring_count() == 1);
+    REQUIRE(small_ring_ways(assembler).empty());
+}
+
+TEST_CASE("Clearing the ring assembler removes all rings") {
+    RingAssembler assembler;
+    assembler.clear(1);
+    assembler.add_way(1, 10, 10);
+    assembler.add_way(2, 20, 21);
+    assembler.clear(1);
+    REQUIRE(assembler.closed_ring_count() == 0);
+    assembler.add_way(3, 21, 20);
+    REQUIRE(assembler.closed_ring_count() == 0);
+}
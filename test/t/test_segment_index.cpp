@@ -0,0 +1,67 @@
+/*
+ * test_segment_index.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include <segment_index.hpp>
+
+static std::vector<size_t> query_sorted(const SegmentIndex& index, const SegmentIndex::BBox& box) {
+    std::vector<size_t> result;
+    index.query(box, [&result](const size_t i) {
+        result.push_back(i);
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+TEST_CASE("Spatial index finds the same segments as a comparison with all segments") {
+    std::mt19937 random {42};
+    std::uniform_real_distribution<double> coordinate {-10.0, 10.0};
+    std::uniform_real_distribution<double> length {-0.5, 0.5};
+    BoundarySegmentStore segments;
+    for (int i = 0; i < 1000; ++i) {
+        const double x = coordinate(random);
+        const double y = coordinate(random);
+        segments.emplace_back(osmium::Location(x, y), osmium::Location(x + length(random), y + length(random)), i, 0, 2);
+    }
+    std::vector<size_t> indexes (segments.size());
+    std::iota(indexes.begin(), indexes.end(), 0);
+
+    SegmentIndex index;
+    index.build(segments, indexes);
+    SegmentIndex index_scalar {SegmentIndex::overlap_mask_scalar};
+    index_scalar.build(segments, indexes);
+    REQUIRE(index.size() == 1000);
+
+    for (int q = 0; q < 200; ++q) {
+        const size_t i = static_cast<size_t>(q) * 5;
+        const SegmentIndex::BBox box {segments, i};
+        std::vector<size_t> expected;
+        for (size_t j = 0; j < segments.size(); ++j) {
+            if (SegmentIndex::BBox{segments, j}.overlaps(box)) {
+                expected.push_back(j);
+            }
+        }
+        REQUIRE(query_sorted(index, box) == expected);
+        REQUIRE(query_sorted(index_scalar, box) == expected);
+    }
+}
+
+TEST_CASE("Spatial index with less segments than a node") {
+    BoundarySegmentStore segments;
+    segments.emplace_back(osmium::Location(1.0, 1.0), osmium::Location(2.0, 2.0), 1, 0, 2);
+    segments.emplace_back(osmium::Location(5.0, 1.0), osmium::Location(6.0, 2.0), 2, 0, 2);
+
+    SegmentIndex index;
+    index.build(segments, {0, 1});
+    REQUIRE(query_sorted(index, SegmentIndex::BBox{segments, 0}) == std::vector<size_t>{0});
+    REQUIRE(query_sorted(index, SegmentIndex::BBox{0, 0, 70000000, 10000000}) == std::vector<size_t>({0, 1}));
+    REQUIRE(query_sorted(index, SegmentIndex::BBox{0, 30000000, 70000000, 40000000}).empty());
+}
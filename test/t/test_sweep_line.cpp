@@ -0,0 +1,103 @@
+/*
+ * test_sweep_line.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include "catch.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#include <sweep_line.hpp>
+
+using pair_list = std::vector<std::pair<size_t, size_t>>;
+
+static bool overlap(const BoundarySegmentStore& segments, const size_t a, const size_t b) {
+    return segments.x_min(a) <= segments.x_max(b) && segments.x_min(b) <= segments.x_max(a)
+            && segments.y_min(a) <= segments.y_max(b) && segments.y_min(b) <= segments.y_max(a);
+}
+
+/**
+ * Run the sweep line and return the pairs ordered by their indexes.
+ */
+static pair_list sweep(const BoundarySegmentStore& segments, const std::vector<size_t>& order,
+        const size_t query_from = 0) {
+    pair_list result;
+    SweepLine sweep_line {segments};
+    sweep_line.run(order, [&result](const size_t index1, const size_t index2) {
+        result.emplace_back(std::min(index1, index2), std::max(index1, index2));
+    }, query_from);
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+/**
+ * Compare all pairs whose second segment is at query_from or later in the order.
+ */
+static pair_list compare_all(const BoundarySegmentStore& segments, const std::vector<size_t>& order,
+        const size_t query_from = 0) {
+    pair_list result;
+    for (size_t i = query_from; i < order.size(); ++i) {
+        for (size_t j = 0; j < i; ++j) {
+            if (overlap(segments, order[i], order[j])) {
+                result.emplace_back(std::min(order[i], order[j]), std::max(order[i], order[j]));
+            }
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+static std::vector<size_t> sorted_by_x_min(const BoundarySegmentStore& segments) {
+    std::vector<size_t> order (segments.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&segments](const size_t a, const size_t b) {
+        return segments.x_min(a) < segments.x_min(b);
+    });
+    return order;
+}
+
+TEST_CASE("Sweep line finds the same pairs as a comparison with all segments") {
+    std::mt19937 random {42};
+    std::uniform_real_distribution<double> coordinate {-10.0, 10.0};
+    std::uniform_real_distribution<double> length {-0.5, 0.5};
+    BoundarySegmentStore segments;
+    for (int i = 0; i < 1000; ++i) {
+        const double x = coordinate(random);
+        const double y = coordinate(random);
+        segments.emplace_back(osmium::Location(x, y), osmium::Location(x + length(random), y + length(random)), i, 0, 2);
+    }
+    // tall and wide segments, segments sharing their lower end and a point
+    segments.emplace_back(osmium::Location(-5.0, -10.0), osmium::Location(-4.9, 10.0), 1000, 0, 2);
+    segments.emplace_back(osmium::Location(3.0, 10.0), osmium::Location(3.0, -10.0), 1001, 0, 2);
+    segments.emplace_back(osmium::Location(-10.0, 0.0), osmium::Location(10.0, 0.1), 1002, 0, 2);
+    segments.emplace_back(osmium::Location(1.0, 0.0), osmium::Location(2.0, 1.0), 1003, 0, 2);
+    segments.emplace_back(osmium::Location(1.5, 0.0), osmium::Location(1.5, 0.0), 1004, 0, 2);
+    const std::vector<size_t> order = sorted_by_x_min(segments);
+
+    REQUIRE(sweep(segments, order) == compare_all(segments, order));
+    REQUIRE(sweep(segments, order, 600) == compare_all(segments, order, 600));
+}
+
+TEST_CASE("Sweep line with a number of lower ends which is not a power of two") {
+    BoundarySegmentStore segments;
+    // five tall segments one after the other, each one overlaps all others
+    for (int i = 0; i < 5; ++i) {
+        segments.emplace_back(osmium::Location(0.1 * i, -1.0 - i), osmium::Location(1.0, 5.0), i, 0, 2);
+    }
+    // a short segment above all lower ends
+    segments.emplace_back(osmium::Location(0.9, 4.0), osmium::Location(1.0, 4.5), 5, 0, 2);
+    const std::vector<size_t> order = sorted_by_x_min(segments);
+
+    REQUIRE(sweep(segments, order).size() == 15);
+    REQUIRE(sweep(segments, order) == compare_all(segments, order));
+}
+
+TEST_CASE("Sweep line with a single segment") {
+    BoundarySegmentStore segments;
+    segments.emplace_back(osmium::Location(1.0, 1.0), osmium::Location(2.0, 2.0), 1, 0, 2);
+    REQUIRE(sweep(segments, std::vector<size_t>{0}).empty());
+    REQUIRE(sweep(segments, std::vector<size_t>{}).empty());
+}
@@ -0,0 +1,198 @@
+/*
+ * test_way_admin_level_index.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include "catch.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <way_admin_level_index.hpp>
+
+static void fill(WayAdminLevelIndex& index) {
+    for (osmium::object_id_type id = 1000; id < 5000; id += 3) {
+        index.store(id, static_cast<WayAdminLevelIndex::AdminLevel>(2 + id % 10));
+    }
+    // duplicates with a higher level are ignored
+    index.store(1000, 8);
+    index.store(1003, 2);
+}
+
+static void check(const WayAdminLevelIndex& index) {
+    REQUIRE(index.size() == 1334);
+    REQUIRE(index.get(999) == WayAdminLevelIndex::NO_LEVEL);
+    REQUIRE(index.get(1000) == 2);
+    REQUIRE(index.get(1001) == WayAdminLevelIndex::NO_LEVEL);
+    REQUIRE(index.get(1003) == 2);
+    REQUIRE(index.get(1001, 11) == 11);
+    for (osmium::object_id_type id = 1006; id < 5000; ++id) {
+        const WayAdminLevelIndex::AdminLevel expected = (id - 1000) % 3 == 0 ? 2 + id % 10 : 0;
+        REQUIRE(index.get(id) == expected);
+    }
+    REQUIRE(index.get(4999) == 11);
+    REQUIRE(index.get(5000) == WayAdminLevelIndex::NO_LEVEL);
+    REQUIRE(index.get(1000000000) == WayAdminLevelIndex::NO_LEVEL);
+}
+
+TEST_CASE("Dense admin level index") {
+    WayAdminLevelIndex index;
+    fill(index);
+    index.prepare_for_query(WayAdminLevelIndex::Layout::dense);
+    REQUIRE(index.layout() == WayAdminLevelIndex::Layout::dense);
+    check(index);
+}
+
+TEST_CASE("Delta-coded admin level index") {
+    WayAdminLevelIndex index;
+    fill(index);
+    index.prepare_for_query(WayAdminLevelIndex::Layout::delta);
+    REQUIRE(index.layout() == WayAdminLevelIndex::Layout::delta);
+    check(index);
+}
+
+TEST_CASE("Admin level index picks the layout by ID range") {
+    WayAdminLevelIndex dense;
+    fill(dense);
+    dense.prepare_for_query();
+    REQUIRE(dense.layout() == WayAdminLevelIndex::Layout::dense);
+
+    // one boundary way every 1000 ways like in the planet
+    WayAdminLevelIndex planet;
+    for (osmium::object_id_type id = 1000; id < 5000000; id += 1000) {
+        planet.store(id, 8);
+    }
+    planet.prepare_for_query();
+    REQUIRE(planet.layout() == WayAdminLevelIndex::Layout::delta);
+    REQUIRE(planet.get(1000) == 8);
+    REQUIRE(planet.get(4999000) == 8);
+    REQUIRE(planet.get(4999001) == WayAdminLevelIndex::NO_LEVEL);
+
+    WayAdminLevelIndex sparse;
+    sparse.store(1, 4);
+    sparse.store(1000000000, 6);
+    sparse.prepare_for_query();
+    REQUIRE(sparse.layout() == WayAdminLevelIndex::Layout::delta);
+    REQUIRE(sparse.get(1) == 4);
+    REQUIRE(sparse.get(1000000000) == 6);
+    REQUIRE(sparse.get(999999999) == WayAdminLevelIndex::NO_LEVEL);
+}
+
+TEST_CASE("Empty admin level index") {
+    WayAdminLevelIndex index;
+    index.prepare_for_query();
+    REQUIRE(index.size() == 0);
+    REQUIRE(index.get(1) == WayAdminLevelIndex::NO_LEVEL);
+}
+
+TEST_CASE("Admin level index answers sequential lookups with a cursor") {
+    WayAdminLevelIndex index;
+    fill(index);
+    index.prepare_for_query(WayAdminLevelIndex::Layout::delta);
+    size_t position = 0;
+    for (osmium::object_id_type id = 1; id < 6000; ++id) {
+        REQUIRE(index.get(id, position) == index.get(id));
+    }
+}
+
+TEST_CASE("Admin level index answers lookups in any order with a cursor") {
+    WayAdminLevelIndex index;
+    fill(index);
+    index.prepare_for_query(WayAdminLevelIndex::Layout::delta);
+    size_t position = 0;
+    REQUIRE(index.get(4000, position) == 2);
+    REQUIRE(index.get(1003, position) == 2);
+    REQUIRE(index.get(999, position) == WayAdminLevelIndex::NO_LEVEL);
+    REQUIRE(index.get(4999, position) == 11);
+    REQUIRE(index.get(1009, position) == 11);
+    REQUIRE(index.get(7000, position, 5) == 5);
+}
+
+static void check_save_and_load(const WayAdminLevelIndex::Layout layout) {
+    const std::string filename = "test_way_admin_level_index.idx";
+    const WayAdminLevelIndex::Source source {1234, 5678, 11};
+    {
+        WayAdminLevelIndex index;
+        fill(index);
+        index.prepare_for_query(layout);
+        index.save(filename, source);
+    }
+    WayAdminLevelIndex loaded;
+    REQUIRE(loaded.load(filename, source));
+    REQUIRE(loaded.layout() == layout);
+    check(loaded);
+    size_t position = 0;
+    REQUIRE(loaded.get(1009, position) == 11);
+
+    WayAdminLevelIndex stale;
+    REQUIRE_FALSE(stale.load(filename, WayAdminLevelIndex::Source{1234, 5679, 11}));
+    REQUIRE_FALSE(stale.load(filename, WayAdminLevelIndex::Source{1234, 5678, 8}));
+    std::remove(filename.c_str());
+    REQUIRE_FALSE(stale.load(filename, source));
+}
+
+TEST_CASE("Dense admin level index can be saved and loaded") {
+    check_save_and_load(WayAdminLevelIndex::Layout::dense);
+}
+
+TEST_CASE("Delta-coded admin level index can be saved and loaded") {
+    check_save_and_load(WayAdminLevelIndex::Layout::delta);
+}
+
+TEST_CASE("Loading an admin level index with invalid block offsets fails") {
+    const std::string filename = "test_way_admin_level_index_corrupt.idx";
+    const WayAdminLevelIndex::Source source {1234, 5678, 11};
+    {
+        WayAdminLevelIndex index;
+        fill(index);
+        index.prepare_for_query(WayAdminLevelIndex::Layout::delta);
+        index.save(filename, source);
+    }
+    std::string content;
+    {
+        std::ifstream file {filename, std::ios::binary};
+        content.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+    }
+    // Every entry written by fill() needs a single byte, the blocks start at 0, 16, 32, ...
+    const uint32_t first_offsets[4] = {0, 16, 32, 48};
+    const size_t position = content.find(std::string{reinterpret_cast<const char*>(first_offsets),
+        sizeof(first_offsets)});
+    REQUIRE(position != std::string::npos);
+    uint32_t offset = 0;
+    SECTION("Offset beyond the end of the entries") {
+        offset = 100000;
+    }
+    SECTION("Decreasing offsets") {
+        offset = 40;
+    }
+    std::memcpy(&content[position + sizeof(uint32_t)], &offset, sizeof(offset));
+    {
+        std::ofstream file {filename, std::ios::binary | std::ios::trunc};
+        file << content;
+    }
+    WayAdminLevelIndex loaded;
+    REQUIRE_THROWS_AS(loaded.load(filename, source), const std::runtime_error&);
+    std::remove(filename.c_str());
+}
+
+TEST_CASE("Source of an input file includes the nanoseconds of the modification time") {
+    const std::string filename = "test_way_admin_level_index_source.osm.pbf";
+    {
+        std::ofstream file {filename, std::ios::binary | std::ios::trunc};
+        file << "data";
+    }
+    struct timespec times[2] = {{1700000000, 100}, {1700000000, 100}};
+    REQUIRE(utimensat(AT_FDCWD, filename.c_str(), times, 0) == 0);
+    const WayAdminLevelIndex::Source first = WayAdminLevelIndex::source_of(filename, 8);
+    times[1].tv_nsec = 200;
+    REQUIRE(utimensat(AT_FDCWD, filename.c_str(), times, 0) == 0);
+    const WayAdminLevelIndex::Source second = WayAdminLevelIndex::source_of(filename, 8);
+    REQUIRE(first.m_file_size == second.m_file_size);
+    REQUIRE(first.m_mtime == 1700000000000000100);
+    REQUIRE(second.m_mtime == 1700000000000000200);
+    std::remove(filename.c_str());
+}
@@ -0,0 +1,58 @@
+/*
+ * test_way_id_set.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include "catch.hpp"
+
+#include <way_id_set.hpp>
+
+TEST_CASE("Way ID set removes duplicates") {
+    WayIdSet set;
+    set.insert(12);
+    set.insert(3);
+    set.insert(12);
+    set.sort();
+    REQUIRE(set.size() == 2);
+    REQUIRE(set.contains(3));
+    REQUIRE(set.contains(12));
+    REQUIRE_FALSE(set.contains(4));
+}
+
+TEST_CASE("Way ID set answers sequential lookups") {
+    WayIdSet set;
+    for (osmium::object_id_type id = 0; id < 1000; id += 7) {
+        set.insert(id);
+    }
+    set.sort();
+    size_t position = 0;
+    for (osmium::object_id_type id = 0; id < 1100; ++id) {
+        REQUIRE(set.contains(id, position) == (id < 1000 && id % 7 == 0));
+    }
+}
+
+TEST_CASE("Way ID set answers lookups in any order") {
+    WayIdSet set;
+    for (osmium::object_id_type id = 1000; id > 0; id -= 10) {
+        set.insert(id);
+    }
+    set.sort();
+    size_t position = 0;
+    REQUIRE(set.contains(900, position));
+    REQUIRE(set.contains(20, position));
+    REQUIRE_FALSE(set.contains(21, position));
+    REQUIRE(set.contains(990, position));
+    REQUIRE_FALSE(set.contains(5, position));
+    REQUIRE(set.contains(10, position));
+    REQUIRE_FALSE(set.contains(2000, position));
+}
+
+TEST_CASE("Way ID set does not find IDs before it has been sorted") {
+    WayIdSet set;
+    set.insert(5);
+    size_t position = 0;
+    REQUIRE_FALSE(set.contains(5, position));
+    set.sort();
+    REQUIRE(set.contains(5, position));
+}
@@ -0,0 +1,69 @@
+/*
+ * test_way_table.cpp
+ *
+ *  Created on:  2026-10-17
+ */
+
+#include "catch.hpp"
+
+#include <way_table.hpp>
+
+static std::vector<int> values(const WayTable<int>& table, const osmium::object_id_type way_id, size_t& position) {
+    std::vector<int> result;
+    auto range = table.equal_range(way_id, position);
+    for (auto it = range.first; it != range.second; ++it) {
+        result.push_back(it->second);
+    }
+    return result;
+}
+
+TEST_CASE("Way table returns the sorted values of a way") {
+    WayTable<int> table;
+    table.insert(7, 3);
+    table.insert(2, 9);
+    table.insert(7, 1);
+    table.insert(5, 4);
+    table.sort();
+
+    REQUIRE(table.size() == 4);
+    size_t position = 0;
+    REQUIRE(values(table, 2, position) == std::vector<int>({9}));
+    REQUIRE(values(table, 3, position).empty());
+    REQUIRE(values(table, 7, position) == std::vector<int>({1, 3}));
+    REQUIRE(position == 4);
+    REQUIRE(values(table, 8, position).empty());
+}
+
+TEST_CASE("Way table lookups work in any order") {
+    WayTable<int> table;
+    for (int i = 0; i < 100; ++i) {
+        table.insert(i / 2, i);
+    }
+    table.sort();
+    size_t position = 0;
+    REQUIRE(values(table, 40, position) == std::vector<int>({80, 81}));
+    REQUIRE(values(table, 3, position) == std::vector<int>({6, 7}));
+    REQUIRE(values(table, 4, position) == std::vector<int>({8, 9}));
+    REQUIRE(values(table, 49, position) == std::vector<int>({98, 99}));
+    REQUIRE(values(table, 0, position) == std::vector<int>({0, 1}));
+}
+
+TEST_CASE("Entries added to a way table become visible after sorting") {
+    WayTable<int> table;
+    table.insert(1, 5);
+    table.insert(3, 5);
+    table.sort();
+    table.insert(2, 8);
+    table.insert(1, 2);
+
+    size_t position = 0;
+    REQUIRE(values(table, 1, position) == std::vector<int>({5}));
+    REQUIRE(values(table, 2, position).empty());
+    REQUIRE(table.count(2) == 1);
+
+    table.sort();
+    position = 0;
+    REQUIRE(values(table, 1, position) == std::vector<int>({2, 5}));
+    REQUIRE(values(table, 2, position) == std::vector<int>({8}));
+    REQUIRE(values(table, 3, position) == std::vector<int>({5}));
+}